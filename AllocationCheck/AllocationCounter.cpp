@@ -0,0 +1,75 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+  #include <malloc.h>
+#endif
+
+// Replacements live apart from the code they count, so the compiler can't inline a delete next to its new and every
+// delete frees the memory the same way as its new allocated it
+namespace
+{
+  std::atomic<std::size_t> allocations_count{ 0 };
+
+  void* AllocateAligned(std::size_t i_size, std::size_t i_alignment)
+  {
+    const std::size_t size = i_size != 0 ? i_size : 1;
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, i_alignment);
+#else
+    // Size of aligned_alloc must be a multiple of the alignment
+    return std::aligned_alloc(i_alignment, (size + i_alignment - 1) / i_alignment * i_alignment);
+#endif
+  }
+
+  void FreeAligned(void* i_memory)
+  {
+#if defined(_MSC_VER)
+    _aligned_free(i_memory);
+#else
+    std::free(i_memory);
+#endif
+  }
+}
+
+std::size_t GetAllocationsCount()
+{
+  return allocations_count.load();
+}
+
+void* operator new(std::size_t i_size)
+{
+  ++allocations_count;
+  if (void* memory = std::malloc(i_size != 0 ? i_size : 1))
+    return memory;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* i_memory) noexcept
+{
+  std::free(i_memory);
+}
+
+void operator delete(void* i_memory, std::size_t) noexcept
+{
+  ::operator delete(i_memory);
+}
+
+void* operator new(std::size_t i_size, std::align_val_t i_alignment)
+{
+  ++allocations_count;
+  if (void* memory = AllocateAligned(i_size, static_cast<std::size_t>(i_alignment)))
+    return memory;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* i_memory, std::align_val_t) noexcept
+{
+  FreeAligned(i_memory);
+}
+
+void operator delete(void* i_memory, std::size_t, std::align_val_t i_alignment) noexcept
+{
+  ::operator delete(i_memory, i_alignment);
+}
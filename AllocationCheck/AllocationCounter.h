@@ -0,0 +1,5 @@
+#pragma once
+#include <cstddef>
+
+// Amount of calls of the replaced global operator new, plain and aligned ones, made by all threads so far
+std::size_t GetAllocationsCount();
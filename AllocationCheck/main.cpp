@@ -0,0 +1,108 @@
+#include "AllocationCounter.h"
+#include "../TTSolver/TaskSolver.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Solves tasks of every pricing rule, with and without capacities and with the thread pool, and fails if the simplex
+// loop touches the heap between its first and its last pivot. Solver sources are built into this target, so the counting
+// operators new of AllocationCounter.cpp replace the ones they call
+namespace
+{
+  using namespace TransportTask;
+
+  // Setup before the first pivot and the SolutionInfo built after the last one may allocate, pivots may not
+  class AllocationObserver : public SolveObserver
+  {
+  public:
+    void OnIteration(const IterationProgress&) override
+    {
+      const SizeType current_count = GetAllocationsCount();
+      if (m_is_started)
+        m_pivots_allocations += current_count - m_last_count;
+      m_is_started = true;
+      m_last_count = current_count;
+    }
+
+    SizeType GetPivotsAllocations() const
+    {
+      return m_pivots_allocations;
+    }
+  private:
+    bool m_is_started = false;
+    SizeType m_last_count = 0;
+    SizeType m_pivots_allocations = 0;
+  };
+
+  // Restricted arcs keep the violating cells they meet, so their lists and the lists of the pricing ranges grow
+  // geometrically and may reallocate a few times over the solve, other rules may not touch the heap at all
+  SizeType GetAllowedAllocations(PricingRule i_rule, SizeType i_cells_count, SizeType i_ranges_count)
+  {
+    if (i_rule != PricingRule::RestrictedArcs)
+      return 0;
+    return (4 + i_ranges_count) * static_cast<SizeType>(std::ceil(std::log2(static_cast<double>(i_cells_count))));
+  }
+
+  TransportInformation CreateTask(SizeType i_rows_count, SizeType i_columns_count, bool i_is_capacitated, std::mt19937& io_random)
+  {
+    Matrix<double> costs(i_rows_count, i_columns_count);
+    Matrix<double> capacities(i_rows_count, i_columns_count);
+    Vector<double> resources(i_rows_count, 0.0);
+    Vector<double> requirements(i_columns_count, 0.0);
+    // Quantities come from a plan within the capacities, so the capacitated task stays feasible
+    for (SizeType i = 0; i < i_rows_count; ++i)
+    {
+      for (SizeType j = 0; j < i_columns_count; ++j)
+      {
+        const double flow = io_random() % 3 == 0 ? static_cast<double>(io_random() % 20) : 0.0;
+        costs[i][j] = static_cast<double>(1 + io_random() % 100);
+        capacities[i][j] = flow + io_random() % 10;
+        resources[i] += flow;
+        requirements[j] += flow;
+      }
+    }
+    resources.front() += 1.0;
+    requirements.front() += 1.0;
+    capacities[0][0] += 1.0;
+    if (i_is_capacitated)
+      return TransportInformation(costs, resources, requirements, capacities);
+    return TransportInformation(costs, resources, requirements);
+  }
+}
+
+int main()
+{
+  std::mt19937 random(42);
+  SolverWorkspace workspace;
+  // Threads of the pool are started before the solves, pricing of the bigger tasks is split between them on every pivot
+  ThreadPool thread_pool(4);
+  bool is_failed = false;
+  for (ThreadPool* pool : { static_cast<ThreadPool*>(nullptr), &thread_pool })
+  {
+    const SizeType rows_count = pool == nullptr ? 60 : 240;
+    const SizeType columns_count = pool == nullptr ? 80 : 320;
+    for (bool is_capacitated : { false, true })
+    {
+      const auto task = CreateTask(rows_count, columns_count, is_capacitated, random);
+      for (SizeType rule = 0; rule < static_cast<SizeType>(PricingRule::LAST); ++rule)
+      {
+        SolverOptions options;
+        options.pricing.rule = static_cast<PricingRule>(rule);
+        options.workspace = &workspace;
+        options.thread_pool = pool;
+        AllocationObserver observer;
+        const auto solution = GetOptimalSolution(task, CreationMethod::NorthWestAngle, options, observer);
+        const SizeType allocations = observer.GetPivotsAllocations();
+        const SizeType allowed_allocations = GetAllowedAllocations(options.pricing.rule, rows_count * columns_count,
+                                                                   GetRangesCount(pool, rows_count, columns_count));
+        std::printf("%-16s %-14s %-11s %6zu pivots %6zu allocations (%zu allowed)\n", GetPricingName(options.pricing.rule).c_str(),
+                    is_capacitated ? "capacitated" : "uncapacitated", pool != nullptr ? "thread pool" : "serial",
+                    solution.GetIterationsCount() - 1, allocations, allowed_allocations);
+        is_failed = is_failed || allocations > allowed_allocations;
+      }
+    }
+  }
+  return is_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
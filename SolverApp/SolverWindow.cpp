@@ -30,10 +30,10 @@ namespace
   {
     constexpr std::size_t description_row_span = 2;
     const std::size_t iterations_count = solution.GetIterationsCount();
-    const std::size_t spacing = solution.solution_steps.back().size() + 8;
-    const std::size_t description_column_span = solution.solution_steps.back().front().size() + 1;
-    const std::size_t rows_count = solution.solution_steps.back().size();
-    const std::size_t columns_count = solution.solution_steps.back().front().size();
+    const std::size_t rows_count = solution.final_basis.GetRowsCount();
+    const std::size_t columns_count = solution.final_basis.GetColumnsCount();
+    const std::size_t spacing = rows_count + 8;
+    const std::size_t description_column_span = columns_count + 1;
 
     xlnt::column_properties column_properties;
     column_properties.width = 50;
@@ -58,12 +58,17 @@ namespace
     settings.horizontal_header = std::move(horizontal_header);
     settings.vertical_header = std::move(vertical_header);
     settings.caption = "Feasible solution matrix";
+    std::size_t printed_steps_count = 0;
     for (int i = 0; i < iterations_count; ++i)
     {
+      if (!solution.IsStepRecorded(i))
+      {
+        continue;
+      }
       auto step_description = TransportTask::GetStepDescription(solution, i);
-      const std::size_t description_row = i * spacing + 1;
+      const std::size_t description_row = printed_steps_count++ * spacing + 1;
       Excel::PrintText(worksheet, description_row, 1, step_description, description_column_span, description_row_span);
-      PrintPotentials(worksheet, solution.potentials[i], description_row + 2, 1);
+      PrintPotentials(worksheet, solution.GetPotentialsAtStep(i), description_row + 2, 1);
       const std::size_t table_row = description_row + 4;
       settings.top_most_row = table_row;
       if (i == iterations_count - 1)
@@ -71,7 +76,7 @@ namespace
         settings.caption = "Optimal solution matrix";
       }
       Excel::SetupExcelFormatting(worksheet, settings);
-      Excel::PrintTableContent(worksheet, settings, solution.solution_steps[i]);
+      Excel::PrintTableContent(worksheet, settings, solution.GetMatrixAtStep(i).ToNested());
     }
   }
 }
@@ -94,8 +99,7 @@ void SolverWindow::SetSolvedProblem(const TransportTask::TransportInformation& s
 {
   problem.reset(new TransportTask::TransportInformation(solved_problem));
   SolveProblem(solved_problem);
-  auto optimal_solution_index = solutions.front().GetIterationsCount() - 1;
-  auto optimal_solution = solutions.front().GetMatrixCostAtStep(optimal_solution_index, solved_problem.m_costs_matrix);
+  auto optimal_solution = solutions.front().objective;
   ui.resultLine->setText(QString::number(optimal_solution));
   DisplayMethodsComparison();
   FillResourcesDistributionInfo();
@@ -113,7 +117,13 @@ void SolverWindow::SolveProblem(const TransportTask::TransportInformation& solve
     auto calculation_method = static_cast<TransportTask::CreationMethod>(i);
     auto actual_task = [&, calculation_method]
     {
-      return ExecutionTime(TransportTask::GetOptimalSolution, solved_problem, calculation_method);
+      auto solver = [](const TransportTask::TransportInformation& problem, TransportTask::CreationMethod method)
+      {
+        TransportTask::SolverOptions options;
+        options.trace_level = TransportTask::TraceLevel::Full;
+        return TransportTask::GetOptimalSolution(problem, method, options);
+      };
+      return ExecutionTime(solver, solved_problem, calculation_method);
     };
     execution_results.push_back(std::move(thread_pool.Execute(actual_task)));
   }
@@ -139,14 +149,14 @@ void SolverWindow::DisplayMethodsComparison()
     SetTableValueAt(i, execution_time_index, timings[i]);
     auto iterations_count = solution.GetIterationsCount();
     SetTableValueAt(i, iterations_index, iterations_count);
-    SetTableValueAt(i, result_index, solution.GetMatrixCostAtStep(iterations_count - 1, problem->m_costs_matrix));
+    SetTableValueAt(i, result_index, solution.objective);
     SetTableValueAt(i, memory_usage, solution.GetAmountOfBytesSpent());
   }
 }
 
 void SolverWindow::FillResourcesDistributionInfo()
 {
-  auto& solution_matrix = solutions.front().solution_steps.back();
+  auto& solution_matrix = solutions.front().final_basis;
   auto distribution_messages = TransportTask::GetResoucesDistributionDetails(solution_matrix);
   if (auto notice_message = problem->GetMessageForState(); notice_message)
   {
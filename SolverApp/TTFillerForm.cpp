@@ -147,7 +147,7 @@ void TTFillerForm::FinishedEditing()
       return;
     }
   }
-  Matrix costs_matrix(rows_count - 1, Vector(columns_count - 1));
+  Matrix costs_matrix(rows_count - 1, columns_count - 1);
   for (int i = 1; i < rows_count; ++i)
   {
     for (int j = 1; j < columns_count; ++j)
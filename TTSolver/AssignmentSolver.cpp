@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "AssignmentSolver.h"
+#include <algorithm>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  constexpr SizeType unassigned = std::numeric_limits<SizeType>::max();
+
+  // Columns are scanned one at a time in order of their distance from the free row, prices of the scanned
+  // columns are lowered so reduced costs stay non-negative and the path found becomes tight
+  void AugmentFromRow(const Matrix<double>& i_costs, SizeType i_free_row, Vector<double>& io_column_prices,
+                      Vector<SizeType>& io_row_columns, Vector<SizeType>& io_column_rows)
+  {
+    const SizeType size = i_costs.GetRowsCount();
+    Vector<double> distances(size);
+    Vector<SizeType> predecessors(size, i_free_row);
+    Vector<std::uint8_t> is_scanned(size, 0);
+    Vector<SizeType> scanned_columns;
+    const auto free_row_costs = i_costs[i_free_row];
+    for (SizeType j = 0; j < size; ++j)
+      distances[j] = free_row_costs[j] - io_column_prices[j];
+
+    SizeType end_column = unassigned;
+    double shortest = 0.0;
+    while (end_column == unassigned)
+    {
+      SizeType column = unassigned;
+      for (SizeType j = 0; j < size; ++j)
+      {
+        if (!is_scanned[j] && (column == unassigned || distances[j] < distances[column]))
+          column = j;
+      }
+      is_scanned[column] = 1;
+      scanned_columns.push_back(column);
+      shortest = distances[column];
+      if (io_column_rows[column] == unassigned)
+      {
+        end_column = column;
+        break;
+      }
+      const SizeType row = io_column_rows[column];
+      const auto row_costs = i_costs[row];
+      const double row_offset = shortest - (row_costs[column] - io_column_prices[column]);
+      for (SizeType j = 0; j < size; ++j)
+      {
+        const double distance = row_costs[j] - io_column_prices[j] + row_offset;
+        if (!is_scanned[j] && distance < distances[j])
+        {
+          distances[j] = distance;
+          predecessors[j] = row;
+        }
+      }
+    }
+
+    for (SizeType column : scanned_columns)
+      io_column_prices[column] += distances[column] - shortest;
+    for (SizeType column = end_column;;)
+    {
+      const SizeType row = predecessors[column];
+      const SizeType previous_column = io_row_columns[row];
+      io_row_columns[row] = column;
+      io_column_rows[column] = row;
+      if (row == i_free_row)
+        break;
+      column = previous_column;
+    }
+  }
+}
+
+namespace TransportTask
+{
+  bool IsAssignmentShaped(const TransportInformation& i_data)
+  {
+    const auto& resources = i_data.m_resources;
+    const auto& requirements = i_data.m_requirements;
+    if (resources.empty() || resources.size() != requirements.size() || resources.front() <= 0.0)
+      return false;
+    auto is_same_amount = [&resources](double i_amount) { return i_amount == resources.front(); };
+    return std::all_of(resources.cbegin(), resources.cend(), is_same_amount)
+      && std::all_of(requirements.cbegin(), requirements.cend(), is_same_amount);
+  }
+
+  Matrix<double> SolveAssignment(const TransportInformation& i_data)
+  {
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    const SizeType size = costs_matrix.GetRowsCount();
+    Vector<double> column_prices(size);
+    Vector<SizeType> row_columns(size, unassigned);
+    Vector<SizeType> column_rows(size, unassigned);
+
+    // Column reduction : every column is priced by its cheapest cell and takes its row if that row is still free
+    for (SizeType j = size; j-- > 0;)
+    {
+      const auto column = costs_matrix.Column(j);
+      SizeType cheapest_row = 0;
+      for (SizeType i = 1; i < size; ++i)
+      {
+        if (column[i] < column[cheapest_row])
+          cheapest_row = i;
+      }
+      column_prices[j] = column[cheapest_row];
+      if (row_columns[cheapest_row] == unassigned)
+      {
+        row_columns[cheapest_row] = j;
+        column_rows[j] = cheapest_row;
+      }
+    }
+    for (SizeType i = 0; i < size; ++i)
+    {
+      if (row_columns[i] == unassigned)
+        AugmentFromRow(costs_matrix, i, column_prices, row_columns, column_rows);
+    }
+
+    MatrixPotentials potentials(size, size);
+    for (SizeType j = 0; j < size; ++j)
+      potentials.m_columns[j] = column_prices[j];
+    for (SizeType i = 0; i < size; ++i)
+      potentials.m_rows[i] = costs_matrix[i][row_columns[i]] - column_prices[row_columns[i]];
+    const double amount = i_data.m_resources.front();
+    Matrix<double> basis(size, size, empty_value);
+    for (SizeType i = 0; i < size; ++i)
+      basis[i][row_columns[i]] = amount;
+
+    // Assigned pairs are joined one by one through the crossing cell of the least reduced cost, potentials of the
+    // joined part are shifted to make that cell tight : its rows get +shift and its columns -shift
+    auto reduced_cost = [&](SizeType i_row, SizeType i_column)
+    {
+      return costs_matrix[i_row][i_column] - potentials.PotentialAt(i_row, i_column);
+    };
+    Vector<std::uint8_t> is_joined(size, 0);
+    Vector<double> column_keys(size, infinity), row_keys(size, infinity);
+    Vector<SizeType> column_key_rows(size), row_key_columns(size);
+    auto join_pair = [&](SizeType i_row)
+    {
+      const SizeType column = row_columns[i_row];
+      is_joined[i_row] = 1;
+      for (SizeType k = 0; k < size; ++k)
+      {
+        const SizeType key_column = row_columns[k];
+        if (is_joined[k])
+          continue;
+        const double row_to_outside = reduced_cost(i_row, key_column);
+        if (row_to_outside < column_keys[key_column])
+        {
+          column_keys[key_column] = row_to_outside;
+          column_key_rows[key_column] = i_row;
+        }
+        const double outside_to_column = reduced_cost(k, column);
+        if (outside_to_column < row_keys[k])
+        {
+          row_keys[k] = outside_to_column;
+          row_key_columns[k] = column;
+        }
+      }
+    };
+    join_pair(0);
+    for (SizeType joined_count = 1; joined_count < size; ++joined_count)
+    {
+      SizeType best_row = unassigned;
+      bool is_column_key = true;
+      double best_key = infinity;
+      for (SizeType k = 0; k < size; ++k)
+      {
+        if (is_joined[k])
+          continue;
+        if (column_keys[row_columns[k]] < best_key)
+        {
+          best_key = column_keys[row_columns[k]];
+          best_row = k;
+          is_column_key = true;
+        }
+        if (row_keys[k] < best_key)
+        {
+          best_key = row_keys[k];
+          best_row = k;
+          is_column_key = false;
+        }
+      }
+      const double shift = is_column_key ? best_key : -best_key;
+      for (SizeType k = 0; k < size; ++k)
+      {
+        if (is_joined[k])
+        {
+          potentials.m_rows[k] += shift;
+          potentials.m_columns[row_columns[k]] -= shift;
+        }
+        else
+        {
+          column_keys[row_columns[k]] -= shift;
+          row_keys[k] += shift;
+        }
+      }
+      if (is_column_key)
+        basis[column_key_rows[row_columns[best_row]]][row_columns[best_row]] = 0.0;
+      else
+        basis[best_row][row_key_columns[best_row]] = 0.0;
+      join_pair(best_row);
+    }
+    return basis;
+  }
+}
\ No newline at end of file
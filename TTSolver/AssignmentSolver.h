@@ -0,0 +1,12 @@
+#pragma once
+#include "Utility.h"
+
+namespace TransportTask
+{
+  // Square task whose resources and requirements all equal the same amount
+  bool IsAssignmentShaped(const TransportInformation& i_data);
+
+  // Jonker-Volgenant shortest augmenting paths over column-reduced costs, O(n^3). Assigned cells are completed
+  // to spanning tree with zero cells of zero reduced cost, so the returned basis is already optimal
+  Matrix<double> SolveAssignment(const TransportInformation& i_data);
+}
\ No newline at end of file
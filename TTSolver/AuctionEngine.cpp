@@ -0,0 +1,578 @@
+#include "pch.h"
+#include "AuctionEngine.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  constexpr SizeType npos = std::numeric_limits<SizeType>::max();
+  constexpr double epsilon_divisor = 4.0;
+  constexpr double steps_tolerance = 1e-6;
+  constexpr double min_decimal_step = 1e-6;
+  constexpr double max_units_count = 1099511627776.0;
+  constexpr double fractional_costs_precision = 1e-6;
+
+  using Units = std::int64_t;
+
+  bool IsMultipleOf(double i_value, double i_step)
+  {
+    const double steps = i_value / i_step;
+    return std::abs(steps - std::round(steps)) <= steps_tolerance;
+  }
+
+  // Units of a row and a column sharing one price and one profit, price + profit is the benefit of the cell, i.e. minus
+  // its cost. Spare units of a column have no row and unassigned units of a row have no column
+  struct Lot
+  {
+    SizeType row;
+    SizeType column;
+    Units amount;
+    double price;
+    double profit;
+  };
+
+  // Forward bids name the column and the new price of its units, reverse ones name the row and the new profit of its units
+  struct Bid
+  {
+    SizeType target;
+    Units amount;
+    double value;
+    // Best value of the bidder minus epsilon, the lowest key which keeps epsilon-CS for its free units
+    double reach;
+  };
+
+  // Lots ordered by price in the columns and by profit in the rows
+  using LotQueue = std::set<std::pair<double, SizeType>>;
+
+  // Bertsekas auction over the units of the task : every unit of a row is a person and every unit of a column is an
+  // object. Forward bids take a slice of the cheapest lots of a column and reverse ones a slice of the lots of the lowest
+  // profit of a row, the units of a slice get one price and one profit and epsilon-CS holds for every unit. Forward
+  // rounds only raise prices and reverse ones only raise profits. Bound of epsilon-CS is the same for all units of a
+  // line, so units pushed out of their cells join the free lot of their line at the smaller of both keys
+  class AuctionMarket
+  {
+  public:
+    AuctionMarket(const TransportInformation& i_data, ThreadPool* i_thread_pool)
+      :m_costs{ i_data.m_costs_matrix }
+      ,m_transposed_costs(i_data.m_requirements.size(), i_data.m_resources.size())
+      ,m_thread_pool{ i_thread_pool }
+      ,m_resources(i_data.m_resources.size())
+      ,m_requirements(i_data.m_requirements.size())
+      ,m_prices(i_data.m_requirements.size(), 0.0)
+      ,m_profits(i_data.m_resources.size(), 0.0)
+      ,m_column_lots(i_data.m_requirements.size())
+      ,m_row_lots(i_data.m_resources.size())
+      ,m_cell_lots(i_data.m_resources.size(), i_data.m_requirements.size(), npos)
+      ,m_spare_lots(i_data.m_requirements.size(), npos)
+      ,m_unassigned_lots(i_data.m_resources.size(), npos)
+    {
+      // Reverse bids scan the columns
+      for (SizeType i = 0; i < m_resources.size(); ++i)
+      {
+        for (SizeType j = 0; j < m_requirements.size(); ++j)
+          m_transposed_costs[j][i] = m_costs[i][j];
+      }
+      m_unit = UnitOf(i_data);
+      for (SizeType i = 0; i < m_resources.size(); ++i)
+        m_resources[i] = std::llround(std::max(i_data.m_resources[i], 0.0) / m_unit);
+      for (SizeType j = 0; j < m_requirements.size(); ++j)
+        m_requirements[j] = std::llround(std::max(i_data.m_requirements[j], 0.0) / m_unit);
+      // Rounding may leave a few units out of balance, the biggest lines take them
+      const Units imbalance = std::accumulate(m_resources.cbegin(), m_resources.cend(), Units{ 0 })
+                            - std::accumulate(m_requirements.cbegin(), m_requirements.cend(), Units{ 0 });
+      if (imbalance > 0)
+        *std::max_element(m_requirements.begin(), m_requirements.end()) += imbalance;
+      else if (imbalance < 0)
+        *std::max_element(m_resources.begin(), m_resources.end()) -= imbalance;
+    }
+
+    Matrix<double> Solve()
+    {
+      const SizeType rows_count = m_resources.size();
+      const SizeType columns_count = m_requirements.size();
+      double max_cost = 0.0;
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        for (double cost : m_costs[i])
+          max_cost = std::max(max_cost, std::abs(cost));
+      }
+      // Costs in decimal steps are optimal below step / (m + n), other ones are left to the simplex loop
+      double final_epsilon = std::max(max_cost, 1.0) * fractional_costs_precision;
+      for (double step = 1.0; step >= min_decimal_step; step /= 10.0)
+      {
+        auto is_step_of = [step](double i_cost) { return IsMultipleOf(i_cost, step); };
+        bool is_step = true;
+        for (SizeType i = 0; i < rows_count && is_step; ++i)
+          is_step = std::all_of(m_costs[i].begin(), m_costs[i].end(), is_step_of);
+        if (is_step)
+        {
+          final_epsilon = step / (rows_count + columns_count + 1);
+          break;
+        }
+      }
+      for (double epsilon = std::max(max_cost / epsilon_divisor, final_epsilon);; epsilon = std::max(epsilon / epsilon_divisor, final_epsilon))
+      {
+        RunPhase(epsilon);
+        if (epsilon == final_epsilon)
+          break;
+      }
+
+      Matrix<double> plan(rows_count, columns_count, empty_value);
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        for (const auto& [price, id] : m_column_lots[j])
+        {
+          const Lot& lot = m_lots[id];
+          if (lot.row != npos)
+            plan[lot.row][j] = (plan[lot.row][j] == empty_value ? 0.0 : plan[lot.row][j]) + lot.amount * m_unit;
+        }
+      }
+      return plan;
+    }
+  private:
+    // Bids move whole units, so lots never split below one unit. The unit is the biggest decimal step which makes all
+    // quantities integral, quantities without one are counted in tiny parts of the total and the plan is approximate
+    static double UnitOf(const TransportInformation& i_data)
+    {
+      double total = 0.0;
+      for (double resource : i_data.m_resources)
+        total += std::max(resource, 0.0);
+      for (double unit = 1.0; unit >= min_decimal_step && total / unit <= max_units_count; unit /= 10.0)
+      {
+        auto is_unit_of = [unit](double i_quantity) { return IsMultipleOf(i_quantity, unit); };
+        if (std::all_of(i_data.m_resources.cbegin(), i_data.m_resources.cend(), is_unit_of)
+            && std::all_of(i_data.m_requirements.cbegin(), i_data.m_requirements.cend(), is_unit_of))
+          return unit;
+      }
+      return std::max(total, 1.0) / max_units_count;
+    }
+
+    // Assignments are dropped, columns keep their prices and rows get the profits of their best columns, so the phase
+    // starts from zero-CS. Direction changes only after the assigned amount grows, which keeps forward/reverse finite
+    void RunPhase(double i_epsilon)
+    {
+      ResetLots();
+      for (bool is_forward = true;;)
+      {
+        const Units assigned_amount = m_assigned_amount;
+        if (is_forward)
+        {
+          CollectBidders(m_unassigned_lots);
+          if (m_bidders.empty())
+            break;
+          MakeBids([this, i_epsilon](SizeType i_row) { return MakeForwardBid(i_row, i_epsilon); });
+          ApplyBids([this](SizeType i_row, const Bid& i_bid) { ApplyForwardBid(i_row, i_bid); });
+        }
+        else
+        {
+          CollectBidders(m_spare_lots);
+          if (m_bidders.empty())
+          {
+            is_forward = true;
+            continue;
+          }
+          MakeBids([this, i_epsilon](SizeType i_column) { return MakeReverseBid(i_column, i_epsilon); });
+          ApplyBids([this](SizeType i_column, const Bid& i_bid) { ApplyReverseBid(i_column, i_bid); });
+        }
+        if (m_assigned_amount > assigned_amount)
+          is_forward = !is_forward;
+      }
+    }
+
+    void ResetLots()
+    {
+      for (const Lot& lot : m_lots)
+      {
+        if (lot.row != npos && lot.column != npos)
+          m_cell_lots[lot.row][lot.column] = npos;
+      }
+      m_lots.clear();
+      m_recycled_lots.clear();
+      m_assigned_amount = 0;
+      for (SizeType j = 0; j < m_requirements.size(); ++j)
+      {
+        m_column_lots[j].clear();
+        m_spare_lots[j] = npos;
+        if (m_requirements[j] > 0)
+          AddToSpare(j, m_requirements[j], m_prices[j]);
+        else
+          RefreshColumn(j);
+      }
+      for (SizeType i = 0; i < m_resources.size(); ++i)
+      {
+        m_row_lots[i].clear();
+        m_unassigned_lots[i] = npos;
+        if (m_resources[i] == 0)
+        {
+          RefreshRow(i);
+          continue;
+        }
+        double profit = -infinity;
+        for (SizeType j = 0; j < m_requirements.size(); ++j)
+        {
+          if (m_requirements[j] > 0)
+            profit = std::max(profit, -m_costs[i][j] - m_prices[j]);
+        }
+        AddToUnassigned(i, m_resources[i], profit);
+      }
+    }
+
+    void CollectBidders(const Vector<SizeType>& i_free_lots)
+    {
+      m_bidders.clear();
+      for (SizeType line = 0; line < i_free_lots.size(); ++line)
+      {
+        if (i_free_lots[line] != npos)
+          m_bidders.push_back(line);
+      }
+    }
+
+    // Bids of a round see the same prices and profits (Jacobi), so they are made by the threads of the pool
+    template <typename BidMaker>
+    void MakeBids(const BidMaker& i_make_bid)
+    {
+      const SizeType bidders_count = m_bidders.size();
+      m_bids.resize(bidders_count);
+      const SizeType targets_count = std::max(m_resources.size(), m_requirements.size());
+      RunInRanges(m_thread_pool, bidders_count, targets_count, [this, &i_make_bid](SizeType, SizeType i_first, SizeType i_last)
+      {
+        for (SizeType k = i_first; k < i_last; ++k)
+          m_bids[k] = i_make_bid(m_bidders[k]);
+      });
+    }
+
+    // Higher bids for a line are applied first, so the lower ones don't push them out in the same round.
+    // The order doesn't depend on the threads count
+    template <typename BidApplier>
+    void ApplyBids(const BidApplier& i_apply_bid)
+    {
+      m_bids_order.resize(m_bids.size());
+      std::iota(m_bids_order.begin(), m_bids_order.end(), SizeType{ 0 });
+      std::sort(m_bids_order.begin(), m_bids_order.end(), [this](SizeType lhs, SizeType rhs)
+      {
+        const Bid& lhs_bid = m_bids[lhs];
+        const Bid& rhs_bid = m_bids[rhs];
+        if (lhs_bid.target != rhs_bid.target)
+          return lhs_bid.target < rhs_bid.target;
+        if (lhs_bid.value != rhs_bid.value)
+          return lhs_bid.value > rhs_bid.value;
+        return lhs < rhs;
+      });
+      for (SizeType k : m_bids_order)
+        i_apply_bid(m_bidders[k], m_bids[k]);
+    }
+
+    // Row pays cost + price, it bids for its best column against the second best one
+    Bid MakeForwardBid(SizeType i_row, double i_epsilon) const
+    {
+      const auto row_costs = m_costs[i_row];
+      SizeType best_column = 0;
+      double best = -infinity, second = -infinity;
+      for (SizeType j = 0; j < row_costs.size(); ++j)
+      {
+        const double value = -row_costs[j] - m_prices[j];
+        if (value > best)
+        {
+          second = best;
+          best = value;
+          best_column = j;
+        }
+        else if (value > second)
+        {
+          second = value;
+        }
+      }
+      Bid bid = MakeBid(m_column_lots[best_column], best_column, row_costs[best_column], second, m_lots[m_unassigned_lots[i_row]].amount, i_epsilon);
+      bid.reach = best - i_epsilon;
+      return bid;
+    }
+
+    // Column bids for its best row against the second best one, symmetric to the forward bid
+    Bid MakeReverseBid(SizeType i_column, double i_epsilon) const
+    {
+      const auto column_costs = m_transposed_costs[i_column];
+      SizeType best_row = 0;
+      double best = -infinity, second = -infinity;
+      for (SizeType i = 0; i < column_costs.size(); ++i)
+      {
+        const double value = -column_costs[i] - m_profits[i];
+        if (value > best)
+        {
+          second = best;
+          best = value;
+          best_row = i;
+        }
+        else if (value > second)
+        {
+          second = value;
+        }
+      }
+      Bid bid = MakeBid(m_row_lots[best_row], best_row, column_costs[best_row], second, m_lots[m_spare_lots[i_column]].amount, i_epsilon);
+      bid.reach = best - i_epsilon;
+      return bid;
+    }
+
+    // Lots of the target are taken cheapest first while they beat the second best line, the bid raises them to the key
+    // of the first unit left or to the bound of the second line plus epsilon, so every taken unit keeps epsilon-CS
+    Bid MakeBid(const LotQueue& i_lots, SizeType i_target, double i_cost, double i_second, Units i_wanted, double i_epsilon) const
+    {
+      const double bound = -i_cost - i_second;
+      double limit = bound;
+      double last_key = infinity;
+      Units amount = 0;
+      for (const auto& [key, id] : i_lots)
+      {
+        if (amount == i_wanted || (amount > 0 && key > bound))
+        {
+          limit = std::min(limit, key);
+          break;
+        }
+        const Units part = std::min(m_lots[id].amount, i_wanted - amount);
+        amount += part;
+        last_key = key;
+        if (part < m_lots[id].amount)
+        {
+          limit = std::min(limit, key);
+          break;
+        }
+      }
+      // Line taken whole without the second one goes up by epsilon only, rounding never lets the bid below its lots
+      if (limit == infinity || limit < last_key)
+        limit = last_key;
+      return { i_target, amount, limit + i_epsilon, 0.0 };
+    }
+
+    // Lots of the column cheaper than the bid go to the row, cheapest first, their rows get the units back unassigned.
+    // Evicted units join other lines than the bid's one, so the walk over the lots of the column stays valid
+    void ApplyForwardBid(SizeType i_row, const Bid& i_bid)
+    {
+      const SizeType column = i_bid.target;
+      const SizeType unassigned_lot = m_unassigned_lots[i_row];
+      if (unassigned_lot == npos)
+        return;
+      const Units amount = std::min(i_bid.amount, m_lots[unassigned_lot].amount);
+      LowerKey(m_row_lots[i_row], unassigned_lot, &Lot::profit, i_bid.reach);
+      RefreshRow(i_row);
+      Units taken = 0;
+      auto& lots = m_column_lots[column];
+      for (auto next = lots.begin(); taken < amount && next != lots.end() && next->first < i_bid.value;)
+      {
+        const SizeType id = (next++)->second;
+        const Lot lot = m_lots[id];
+        const Units part = std::min(lot.amount, amount - taken);
+        if (lot.row == npos)
+          m_assigned_amount += part;
+        else
+          AddToUnassigned(lot.row, part, lot.profit);
+        Reduce(id, part);
+        taken += part;
+      }
+      if (taken == 0)
+        return;
+      Reduce(m_unassigned_lots[i_row], taken);
+      AddHolding(i_row, column, taken, i_bid.value, -m_costs[i_row][column] - i_bid.value, true);
+    }
+
+    // Lots of the row with lower profit than the bid go to the column, their columns get the units back as spare ones
+    void ApplyReverseBid(SizeType i_column, const Bid& i_bid)
+    {
+      const SizeType row = i_bid.target;
+      const SizeType spare_lot = m_spare_lots[i_column];
+      if (spare_lot == npos)
+        return;
+      const Units amount = std::min(i_bid.amount, m_lots[spare_lot].amount);
+      LowerKey(m_column_lots[i_column], spare_lot, &Lot::price, i_bid.reach);
+      RefreshColumn(i_column);
+      Units taken = 0;
+      auto& lots = m_row_lots[row];
+      for (auto next = lots.begin(); taken < amount && next != lots.end() && next->first < i_bid.value;)
+      {
+        const SizeType id = (next++)->second;
+        const Lot lot = m_lots[id];
+        const Units part = std::min(lot.amount, amount - taken);
+        if (lot.column == npos)
+          m_assigned_amount += part;
+        else
+          AddToSpare(lot.column, part, lot.price);
+        Reduce(id, part);
+        taken += part;
+      }
+      if (taken == 0)
+        return;
+      Reduce(m_spare_lots[i_column], taken);
+      AddHolding(row, i_column, taken, -m_costs[row][i_column] - i_bid.value, i_bid.value, false);
+    }
+
+    SizeType CreateLot(const Lot& i_lot)
+    {
+      if (m_recycled_lots.empty())
+      {
+        m_lots.push_back(i_lot);
+        return m_lots.size() - 1;
+      }
+      const SizeType id = m_recycled_lots.back();
+      m_recycled_lots.pop_back();
+      m_lots[id] = i_lot;
+      return id;
+    }
+
+    // Units of one cell stay in one lot. Bound of epsilon-CS is the same for all units of a row and for all units of
+    // a column, so the merged lot keeps it with either key, forward rounds keep the bigger price and reverse ones the
+    // bigger profit, so prices only grow in the first and profits in the second
+    void AddHolding(SizeType i_row, SizeType i_column, Units i_amount, double i_price, double i_profit, bool i_is_forward)
+    {
+      SizeType& id = m_cell_lots[i_row][i_column];
+      if (id == npos)
+      {
+        id = CreateLot({ i_row, i_column, i_amount, i_price, i_profit });
+        m_column_lots[i_column].emplace(i_price, id);
+        m_row_lots[i_row].emplace(i_profit, id);
+      }
+      else
+      {
+        Lot& lot = m_lots[id];
+        lot.amount += i_amount;
+        if (i_is_forward ? i_price > lot.price : i_profit > lot.profit)
+        {
+          m_column_lots[i_column].erase({ lot.price, id });
+          m_row_lots[i_row].erase({ lot.profit, id });
+          lot.price = i_price;
+          lot.profit = i_profit;
+          m_column_lots[i_column].emplace(i_price, id);
+          m_row_lots[i_row].emplace(i_profit, id);
+        }
+      }
+      RefreshColumn(i_column);
+      RefreshRow(i_row);
+    }
+
+    void AddToUnassigned(SizeType i_row, Units i_amount, double i_profit)
+    {
+      SizeType& id = m_unassigned_lots[i_row];
+      if (id == npos)
+      {
+        id = CreateLot({ i_row, npos, i_amount, 0.0, i_profit });
+        m_row_lots[i_row].emplace(i_profit, id);
+      }
+      else
+      {
+        Lot& lot = m_lots[id];
+        lot.amount += i_amount;
+        if (i_profit < lot.profit)
+        {
+          m_row_lots[i_row].erase({ lot.profit, id });
+          lot.profit = i_profit;
+          m_row_lots[i_row].emplace(i_profit, id);
+        }
+      }
+      RefreshRow(i_row);
+    }
+
+    void AddToSpare(SizeType i_column, Units i_amount, double i_price)
+    {
+      SizeType& id = m_spare_lots[i_column];
+      if (id == npos)
+      {
+        id = CreateLot({ npos, i_column, i_amount, i_price, 0.0 });
+        m_column_lots[i_column].emplace(i_price, id);
+      }
+      else
+      {
+        Lot& lot = m_lots[id];
+        lot.amount += i_amount;
+        if (i_price < lot.price)
+        {
+          m_column_lots[i_column].erase({ lot.price, id });
+          lot.price = i_price;
+          m_column_lots[i_column].emplace(i_price, id);
+        }
+      }
+      RefreshColumn(i_column);
+    }
+
+    // Free units of a bidder go down to its reach, so the bids of the other side find them first
+    void LowerKey(LotQueue& io_lots, SizeType i_id, double Lot::* i_key, double i_value)
+    {
+      Lot& lot = m_lots[i_id];
+      if (i_value >= lot.*i_key)
+        return;
+      io_lots.erase({ lot.*i_key, i_id });
+      lot.*i_key = i_value;
+      io_lots.emplace(i_value, i_id);
+    }
+
+    void Reduce(SizeType i_id, Units i_amount)
+    {
+      Lot& lot = m_lots[i_id];
+      lot.amount -= i_amount;
+      if (lot.amount > 0)
+        return;
+      if (lot.column != npos)
+      {
+        m_column_lots[lot.column].erase({ lot.price, i_id });
+        if (lot.row == npos)
+          m_spare_lots[lot.column] = npos;
+        RefreshColumn(lot.column);
+      }
+      if (lot.row != npos)
+      {
+        m_row_lots[lot.row].erase({ lot.profit, i_id });
+        if (lot.column == npos)
+          m_unassigned_lots[lot.row] = npos;
+        RefreshRow(lot.row);
+      }
+      if (lot.row != npos && lot.column != npos)
+        m_cell_lots[lot.row][lot.column] = npos;
+      m_recycled_lots.push_back(i_id);
+    }
+
+    void RefreshColumn(SizeType i_column)
+    {
+      const auto& lots = m_column_lots[i_column];
+      m_prices[i_column] = lots.empty() ? infinity : lots.begin()->first;
+    }
+
+    void RefreshRow(SizeType i_row)
+    {
+      const auto& lots = m_row_lots[i_row];
+      m_profits[i_row] = lots.empty() ? infinity : lots.begin()->first;
+    }
+
+    const Matrix<double>& m_costs;
+    Matrix<double> m_transposed_costs;
+    ThreadPool* m_thread_pool;
+    // Quantities of the lines in units
+    Vector<Units> m_resources;
+    Vector<Units> m_requirements;
+    double m_unit = 1.0;
+    Units m_assigned_amount = 0;
+    // Price of the cheapest lot of every column and profit of the lowest lot of every row, infinity for empty lines
+    Vector<double> m_prices;
+    Vector<double> m_profits;
+    Vector<Lot> m_lots;
+    Vector<SizeType> m_recycled_lots;
+    Vector<LotQueue> m_column_lots;
+    Vector<LotQueue> m_row_lots;
+    Matrix<SizeType> m_cell_lots;
+    Vector<SizeType> m_spare_lots;
+    Vector<SizeType> m_unassigned_lots;
+    Vector<SizeType> m_bidders;
+    Vector<Bid> m_bids;
+    Vector<SizeType> m_bids_order;
+  };
+}
+
+namespace TransportTask
+{
+  Matrix<double> SolveByAuction(const TransportInformation& i_data, ThreadPool* i_thread_pool)
+  {
+    AuctionMarket market(i_data, i_thread_pool);
+    return market.Solve();
+  }
+}
\ No newline at end of file
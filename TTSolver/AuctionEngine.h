@@ -0,0 +1,14 @@
+#pragma once
+#include "Utility.h"
+
+class ThreadPool;
+
+namespace TransportTask
+{
+  // Bertsekas forward/reverse auction with epsilon scaling over the units of the task : rows bid for slices of the
+  // cheapest units of columns and columns bid back for slices of the units of rows. Bids of a round are computed at once
+  // (Jacobi) and split between the threads of the pool if it is given. Quantities are counted in the biggest decimal
+  // unit which makes them integral, so without one the plan is approximate and has to be repaired by the caller.
+  // Cells without flow keep empty_value
+  Matrix<double> SolveByAuction(const TransportInformation& i_data, ThreadPool* i_thread_pool = nullptr);
+}
\ No newline at end of file
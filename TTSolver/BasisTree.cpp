@@ -0,0 +1,461 @@
+#include "pch.h"
+#include "BasisTree.h"
+#include "ReducedCostKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace TransportTask
+{
+  BasisTree::BasisTree(const Matrix<double>& i_basis_matrix, const Matrix<double>& i_costs, SolverWorkspace& io_workspace)
+    :BasisTree(i_basis_matrix, {}, i_costs, Matrix<double>{}, io_workspace)
+  {}
+
+  BasisTree::BasisTree(const Matrix<double>& i_basis_matrix, const Vector<BasisCell>& i_saturated_cells, const Matrix<double>& i_costs,
+                       const Matrix<double>& i_capacities, SolverWorkspace& io_workspace)
+    :m_costs{ i_costs }
+    ,m_capacities{ i_capacities.GetRowsCount() != 0 ? &i_capacities : nullptr }
+    ,m_rows_count{ i_basis_matrix.GetRowsCount() }
+    ,m_columns_count{ i_basis_matrix.GetColumnsCount() }
+    ,m_parent{ io_workspace.m_parent }
+    ,m_depth{ io_workspace.m_depth }
+    ,m_thread{ io_workspace.m_thread }
+    ,m_reverse_thread{ io_workspace.m_reverse_thread }
+    ,m_flow{ io_workspace.m_flow }
+    ,m_first_half_edge{ io_workspace.m_first_half_edge }
+    ,m_next_half_edge{ io_workspace.m_next_half_edge }
+    ,m_previous_half_edge{ io_workspace.m_previous_half_edge }
+    ,m_half_edge_target{ io_workspace.m_half_edge_target }
+    ,m_basis_mask{ io_workspace.m_basis_mask }
+    ,m_potentials{ io_workspace.m_potentials }
+    ,m_checked_potentials{ io_workspace.m_checked_potentials }
+    ,m_nodes_stack{ io_workspace.m_nodes_stack }
+    ,m_visited{ io_workspace.m_visited }
+    ,m_cycle{ io_workspace.m_cycle }
+  {
+    io_workspace.Prepare(m_rows_count, m_columns_count);
+    const SizeType nodes_count = m_rows_count + m_columns_count;
+    SizeType basic_cells_count = 0;
+    for (SizeType i = 0; i < m_rows_count; ++i)
+    {
+      for (SizeType j = 0; j < m_columns_count; ++j)
+      {
+        if (i_basis_matrix[i][j] != empty_value)
+        {
+          if (basic_cells_count == nodes_count - 1)
+            throw std::runtime_error{ "Matrix degenerated !" };
+          LinkEdge(basic_cells_count++, i, ColumnNode(j));
+          m_basis_mask[i * m_columns_count + j] = basic_mask;
+        }
+      }
+    }
+    if (basic_cells_count != nodes_count - 1 || !IsConnected())
+      throw std::runtime_error{ "Matrix degenerated !" };
+    for (const auto& cell : i_saturated_cells)
+    {
+      auto& mask = MaskOf({ cell.row, cell.column });
+      if (m_capacities == nullptr || mask != lower_bound_mask)
+        throw std::runtime_error{ "Saturated cell isn't a non-basic cell of capacitated task !" };
+      mask = upper_bound_mask;
+    }
+
+    AttachSubtree(0, npos);
+
+    for (SizeType node = 1; node < nodes_count; ++node)
+    {
+      auto [row, column] = CellOf(node, m_parent[node]);
+      m_flow[node] = i_basis_matrix[row][column];
+    }
+    CalculatePotentials();
+  }
+
+  SizeType BasisTree::GetRowsCount() const
+  {
+    return m_rows_count;
+  }
+
+  SizeType BasisTree::GetColumnsCount() const
+  {
+    return m_columns_count;
+  }
+
+  bool BasisTree::IsBasic(SizeType i_row, SizeType i_column) const
+  {
+    return m_basis_mask[i_row * m_columns_count + i_column] == basic_mask;
+  }
+
+  bool BasisTree::IsAtLowerBound(SizeType i_row, SizeType i_column) const
+  {
+    return m_basis_mask[i_row * m_columns_count + i_column] == lower_bound_mask;
+  }
+
+  void BasisTree::CollectSaturatedCells(Vector<BasisCell>& io_cells) const
+  {
+    if (m_capacities == nullptr)
+      return;
+    for (SizeType i = 0; i < m_rows_count; ++i)
+    {
+      const auto mask_row = GetBasisMaskRow(i);
+      for (SizeType j = 0; j < m_columns_count; ++j)
+      {
+        if (mask_row[j] == upper_bound_mask)
+          io_cells.push_back({ static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j), (*m_capacities)[i][j] });
+      }
+    }
+  }
+
+  const std::uint8_t* BasisTree::GetBasisMaskRow(SizeType i_row) const
+  {
+    return m_basis_mask.data() + i_row * m_columns_count;
+  }
+
+  const MatrixPotentials& BasisTree::GetPotentials() const
+  {
+    return m_potentials;
+  }
+
+  SizeType BasisTree::GetParent(SizeType i_node) const
+  {
+    return m_parent[i_node];
+  }
+
+  SizeType BasisTree::GetDepth(SizeType i_node) const
+  {
+    return m_depth[i_node];
+  }
+
+  double BasisTree::GetFlow(SizeType i_node) const
+  {
+    return m_flow[i_node];
+  }
+
+  PairOf<SizeType> BasisTree::GetParentCell(SizeType i_node) const
+  {
+    return CellOf(i_node, m_parent[i_node]);
+  }
+
+  const Vector<BasisTree::CycleElement>& BasisTree::FindCycle(const PairOf<SizeType>& i_entering)
+  {
+    const SizeType first = i_entering.first;
+    const SizeType second = ColumnNode(i_entering.second);
+    m_cycle.clear();
+
+    // Both ends climb to the join node, the first path is then reversed so the cycle starts at the join node
+    SizeType join_first = first, join_second = second;
+    while (join_first != join_second)
+    {
+      if (m_depth[join_first] >= m_depth[join_second])
+        join_first = m_parent[join_first];
+      else
+        join_second = m_parent[join_second];
+    }
+    for (SizeType node = first; node != join_first; node = m_parent[node])
+      m_cycle.push_back({ node, CellOf(node, m_parent[node]), !IsRowNode(node) });
+    std::reverse(m_cycle.begin(), m_cycle.end());
+    m_entering_position = m_cycle.size();
+    m_cycle.push_back({ npos, i_entering, true });
+    for (SizeType node = second; node != join_first; node = m_parent[node])
+      m_cycle.push_back({ node, CellOf(node, m_parent[node]), IsRowNode(node) });
+    return m_cycle;
+  }
+
+  PivotRecord BasisTree::Pivot(const PairOf<SizeType>& i_entering)
+  {
+    const SizeType first = i_entering.first;
+    const SizeType second = ColumnNode(i_entering.second);
+    const double entering_reduced_cost = m_costs[first][i_entering.second] - m_potentials.PotentialAt(first, i_entering.second);
+    FindCycle(i_entering);
+
+    // Saturated entering cell decreases its flow, so the cycle is passed in the opposite direction. The last blocking
+    // cell met on the way from the join node in the direction of flow leaves the basis, this keeps the tree strongly
+    // feasible. If the entering cell blocks first, it only moves to its other bound
+    const bool is_decreasing = MaskOf(i_entering) == upper_bound_mask;
+    const double entering_capacity = CapacityOf(i_entering);
+    double theta = is_decreasing ? entering_capacity : std::min(entering_capacity, std::numeric_limits<double>::max());
+    SizeType leaving_position = npos;
+    for (SizeType position = 0; position < m_cycle.size(); ++position)
+    {
+      const auto& element = m_cycle[position];
+      if (element.node == npos)
+        continue;
+      const double room = element.is_increased != is_decreasing ? CapacityOf(element.cell) - m_flow[element.node] : m_flow[element.node];
+      if (room < theta || (room == theta && !is_decreasing))
+      {
+        theta = room;
+        leaving_position = position;
+      }
+    }
+    const double signed_theta = is_decreasing ? -theta : theta;
+    for (const auto& element : m_cycle)
+    {
+      if (element.node != npos)
+        m_flow[element.node] += element.is_increased ? signed_theta : -signed_theta;
+    }
+    if (leaving_position == npos)
+    {
+      MaskOf(i_entering) = is_decreasing ? lower_bound_mask : upper_bound_mask;
+      return { i_entering, i_entering, signed_theta, entering_reduced_cost };
+    }
+    const SizeType leaving = m_cycle[leaving_position].node;
+    const bool leaving_on_first_path = leaving_position < m_entering_position;
+    const bool is_leaving_saturated = m_cycle[leaving_position].is_increased != is_decreasing;
+
+    const SizeType leaving_parent = m_parent[leaving];
+    const auto leaving_cell = CellOf(leaving, leaving_parent);
+    MaskOf(leaving_cell) = is_leaving_saturated ? upper_bound_mask : lower_bound_mask;
+    MaskOf(i_entering) = basic_mask;
+    // Edge of the leaving cell is reused by the entering one
+    const SizeType reused_half_edge = FindHalfEdge(leaving, leaving_parent);
+    UnlinkHalfEdge(leaving, reused_half_edge);
+    UnlinkHalfEdge(leaving_parent, reused_half_edge ^ 1);
+    LinkEdge(reused_half_edge / 2, first, second);
+
+    // Cut the thread segment of the leaving subtree, it is reattached below the other end of the entering cell
+    SizeType subtree_last = leaving;
+    while (m_depth[m_thread[subtree_last]] > m_depth[leaving])
+      subtree_last = m_thread[subtree_last];
+    const SizeType before_subtree = m_reverse_thread[leaving];
+    const SizeType after_subtree = m_thread[subtree_last];
+    m_thread[before_subtree] = after_subtree;
+    m_reverse_thread[after_subtree] = before_subtree;
+
+    const SizeType new_subtree_root = leaving_on_first_path ? first : second;
+    SizeType new_parent = leaving_on_first_path ? second : first;
+    SizeType node = new_subtree_root;
+    double carried_flow = is_decreasing ? entering_capacity - theta : theta;
+    for (;;)
+    {
+      const SizeType old_parent = m_parent[node];
+      const double old_flow = m_flow[node];
+      m_parent[node] = new_parent;
+      m_flow[node] = carried_flow;
+      if (node == leaving)
+        break;
+      new_parent = node;
+      carried_flow = old_flow;
+      node = old_parent;
+    }
+    const SizeType new_subtree_last = AttachSubtree(new_subtree_root, m_parent[new_subtree_root]);
+
+    // Only the reattached subtree changes its potentials : rows and columns are shifted in opposite directions
+    const double rows_shift = leaving_on_first_path ? entering_reduced_cost : -entering_reduced_cost;
+    for (SizeType node = new_subtree_root;; node = m_thread[node])
+    {
+      PotentialOf(node) += IsRowNode(node) ? rows_shift : -rows_shift;
+      if (node == new_subtree_last)
+        break;
+    }
+    return { i_entering, leaving_cell, signed_theta, entering_reduced_cost };
+  }
+
+  SizeType BasisTree::GetCycleLength() const
+  {
+    return m_cycle.size();
+  }
+
+  void BasisTree::CollectCycleCells(Vector<CycleCell>& io_cells) const
+  {
+    for (SizeType k = 0; k < m_cycle.size(); ++k)
+    {
+      const auto [row, column] = m_cycle[(m_entering_position + k) % m_cycle.size()].cell;
+      io_cells.push_back({ static_cast<std::uint32_t>(row), static_cast<std::uint32_t>(column) });
+    }
+  }
+
+  void BasisTree::CollectBasicCells(Vector<BasisCell>& io_cells) const
+  {
+    for (SizeType node = 1; node < m_parent.size(); ++node)
+    {
+      auto [row, column] = CellOf(node, m_parent[node]);
+      io_cells.push_back({ static_cast<std::uint32_t>(row), static_cast<std::uint32_t>(column), m_flow[node] });
+    }
+  }
+
+  double BasisTree::CalculateObjective() const
+  {
+    double objective = 0.0;
+    for (SizeType node = 1; node < m_parent.size(); ++node)
+    {
+      auto [row, column] = CellOf(node, m_parent[node]);
+      objective += m_flow[node] * m_costs[row][column];
+    }
+    if (m_capacities == nullptr)
+      return objective;
+    for (SizeType i = 0; i < m_rows_count; ++i)
+    {
+      const auto mask_row = GetBasisMaskRow(i);
+      for (SizeType j = 0; j < m_columns_count; ++j)
+      {
+        if (mask_row[j] == upper_bound_mask)
+          objective += (*m_capacities)[i][j] * m_costs[i][j];
+      }
+    }
+    return objective;
+  }
+
+  double BasisTree::RecalculatePotentials()
+  {
+    m_checked_potentials.m_rows = m_potentials.m_rows;
+    m_checked_potentials.m_columns = m_potentials.m_columns;
+    CalculatePotentials();
+    double max_drift = 0.0;
+    for (SizeType i = 0; i < m_rows_count; ++i)
+      max_drift = std::max(max_drift, std::abs(m_checked_potentials.m_rows[i] - m_potentials.m_rows[i]));
+    for (SizeType j = 0; j < m_columns_count; ++j)
+      max_drift = std::max(max_drift, std::abs(m_checked_potentials.m_columns[j] - m_potentials.m_columns[j]));
+    return max_drift;
+  }
+
+  Matrix<double> BasisTree::ToMatrix() const
+  {
+    Matrix<double> basis_matrix(m_rows_count, m_columns_count, empty_value);
+    for (SizeType node = 1; node < m_parent.size(); ++node)
+    {
+      auto [row, column] = CellOf(node, m_parent[node]);
+      basis_matrix[row][column] = m_flow[node];
+    }
+    return basis_matrix;
+  }
+
+  bool BasisTree::IsRowNode(SizeType i_node) const
+  {
+    return i_node < m_rows_count;
+  }
+
+  SizeType BasisTree::ColumnNode(SizeType i_column) const
+  {
+    return m_rows_count + i_column;
+  }
+
+  PairOf<SizeType> BasisTree::CellOf(SizeType i_node, SizeType i_parent) const
+  {
+    if (IsRowNode(i_node))
+      return { i_node, i_parent - m_rows_count };
+    return { i_parent, i_node - m_rows_count };
+  }
+
+  double BasisTree::CapacityOf(const PairOf<SizeType>& i_cell) const
+  {
+    return m_capacities != nullptr ? (*m_capacities)[i_cell.first][i_cell.second] : std::numeric_limits<double>::infinity();
+  }
+
+  std::uint8_t& BasisTree::MaskOf(const PairOf<SizeType>& i_cell)
+  {
+    return m_basis_mask[i_cell.first * m_columns_count + i_cell.second];
+  }
+
+  double& BasisTree::PotentialOf(SizeType i_node)
+  {
+    return IsRowNode(i_node) ? m_potentials.m_rows[i_node] : m_potentials.m_columns[i_node - m_rows_count];
+  }
+
+  SizeType BasisTree::AttachSubtree(SizeType i_subtree_root, SizeType i_after)
+  {
+    m_depth[i_subtree_root] = i_after == npos ? 0 : m_depth[i_after] + 1;
+    SizeType last_visited = npos;
+    m_nodes_stack.clear();
+    m_nodes_stack.push_back(i_subtree_root);
+    while (!m_nodes_stack.empty())
+    {
+      const SizeType node = m_nodes_stack.back();
+      m_nodes_stack.pop_back();
+      if (last_visited != npos)
+      {
+        m_thread[last_visited] = node;
+        m_reverse_thread[node] = last_visited;
+      }
+      last_visited = node;
+      for (SizeType half_edge = m_first_half_edge[node]; half_edge != npos; half_edge = m_next_half_edge[half_edge])
+      {
+        const SizeType neighbour = m_half_edge_target[half_edge];
+        if (neighbour != m_parent[node])
+        {
+          m_parent[neighbour] = node;
+          m_depth[neighbour] = m_depth[node] + 1;
+          m_nodes_stack.push_back(neighbour);
+        }
+      }
+    }
+
+    const SizeType after_subtree = i_after == npos ? i_subtree_root : m_thread[i_after];
+    const SizeType before_subtree = i_after == npos ? last_visited : i_after;
+    m_thread[last_visited] = after_subtree;
+    m_reverse_thread[after_subtree] = last_visited;
+    m_thread[before_subtree] = i_subtree_root;
+    m_reverse_thread[i_subtree_root] = before_subtree;
+    return last_visited;
+  }
+
+  bool BasisTree::IsConnected()
+  {
+    std::fill(m_visited.begin(), m_visited.end(), 0);
+    SizeType visited_count = 1;
+    m_visited.front() = 1;
+    m_nodes_stack.assign(1, 0);
+    while (!m_nodes_stack.empty())
+    {
+      const SizeType node = m_nodes_stack.back();
+      m_nodes_stack.pop_back();
+      for (SizeType half_edge = m_first_half_edge[node]; half_edge != npos; half_edge = m_next_half_edge[half_edge])
+      {
+        const SizeType neighbour = m_half_edge_target[half_edge];
+        if (!m_visited[neighbour])
+        {
+          m_visited[neighbour] = 1;
+          ++visited_count;
+          m_nodes_stack.push_back(neighbour);
+        }
+      }
+    }
+    return visited_count == m_visited.size();
+  }
+
+  void BasisTree::LinkEdge(SizeType i_edge, SizeType i_first_node, SizeType i_second_node)
+  {
+    m_half_edge_target[2 * i_edge] = i_second_node;
+    m_half_edge_target[2 * i_edge + 1] = i_first_node;
+    PushHalfEdge(i_first_node, 2 * i_edge);
+    PushHalfEdge(i_second_node, 2 * i_edge + 1);
+  }
+
+  void BasisTree::PushHalfEdge(SizeType i_node, SizeType i_half_edge)
+  {
+    const SizeType next = m_first_half_edge[i_node];
+    m_next_half_edge[i_half_edge] = next;
+    m_previous_half_edge[i_half_edge] = npos;
+    if (next != npos)
+      m_previous_half_edge[next] = i_half_edge;
+    m_first_half_edge[i_node] = i_half_edge;
+  }
+
+  void BasisTree::UnlinkHalfEdge(SizeType i_node, SizeType i_half_edge)
+  {
+    const SizeType previous = m_previous_half_edge[i_half_edge];
+    const SizeType next = m_next_half_edge[i_half_edge];
+    if (previous != npos)
+      m_next_half_edge[previous] = next;
+    else
+      m_first_half_edge[i_node] = next;
+    if (next != npos)
+      m_previous_half_edge[next] = previous;
+  }
+
+  SizeType BasisTree::FindHalfEdge(SizeType i_node, SizeType i_neighbour) const
+  {
+    SizeType half_edge = m_first_half_edge[i_node];
+    while (m_half_edge_target[half_edge] != i_neighbour)
+      half_edge = m_next_half_edge[half_edge];
+    return half_edge;
+  }
+
+  void BasisTree::CalculatePotentials()
+  {
+    m_potentials.m_rows.front() = 0.0;
+    for (SizeType node = m_thread.front(); node != 0; node = m_thread[node])
+    {
+      const SizeType parent = m_parent[node];
+      auto [row, column] = CellOf(node, parent);
+      PotentialOf(node) = m_costs[row][column] - PotentialOf(parent);
+    }
+  }
+}
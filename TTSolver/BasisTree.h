@@ -0,0 +1,121 @@
+#pragma once
+#include "Utility.h"
+#include "SolverWorkspace.h"
+#include <cstdint>
+
+namespace TransportTask
+{
+  // Basis of the transport task stored as spanning tree over rows [0, m) and columns [m, m + n),
+  // tree is rooted at the first row, every non-root node keeps the flow of the cell linking it with its parent.
+  // All buffers belong to the workspace, the workspace must outlive the tree and must not be used by another tree meanwhile
+  class BasisTree
+  {
+  public:
+    static constexpr SizeType npos = std::numeric_limits<SizeType>::max();
+
+    using CycleElement = BasisCycleElement;
+
+    BasisTree(const Matrix<double>& i_basis_matrix, const Matrix<double>& i_costs, SolverWorkspace& io_workspace);
+
+    // Capacitated task : non-basic cells carrying their capacities are given apart from the basis matrix,
+    // pivots follow the bounded variable rules and an entering saturated cell decreases its flow
+    BasisTree(const Matrix<double>& i_basis_matrix, const Vector<BasisCell>& i_saturated_cells, const Matrix<double>& i_costs,
+              const Matrix<double>& i_capacities, SolverWorkspace& io_workspace);
+
+    SizeType GetRowsCount() const;
+
+    SizeType GetColumnsCount() const;
+
+    bool IsBasic(SizeType i_row, SizeType i_column) const;
+
+    // Non-basic cell without flow, only such cells may enter with growing flow
+    bool IsAtLowerBound(SizeType i_row, SizeType i_column) const;
+
+    // Saturated cells are kept only by their basis mask, so they are collected by a scan of the mask
+    void CollectSaturatedCells(Vector<BasisCell>& io_cells) const;
+
+    const std::uint8_t* GetBasisMaskRow(SizeType i_row) const;
+
+    const MatrixPotentials& GetPotentials() const;
+
+    // Parent of the root is npos
+    SizeType GetParent(SizeType i_node) const;
+
+    SizeType GetDepth(SizeType i_node) const;
+
+    // Flow of the cell linking the non-root node with its parent
+    double GetFlow(SizeType i_node) const;
+
+    PairOf<SizeType> GetParentCell(SizeType i_node) const;
+
+    // Ordered cycle closed by the entering cell, it starts at the join node of the tree paths of both ends
+    const Vector<CycleElement>& FindCycle(const PairOf<SizeType>& i_entering);
+
+    PivotRecord Pivot(const PairOf<SizeType>& i_entering);
+
+    SizeType GetCycleLength() const;
+
+    // Cells of the cycle of the last pivot starting from the entering cell, so their signs alternate
+    void CollectCycleCells(Vector<CycleCell>& io_cells) const;
+
+    void CollectBasicCells(Vector<BasisCell>& io_cells) const;
+
+    // Sum of flow * cost over the basic and the saturated cells
+    double CalculateObjective() const;
+
+    // Rebuilds potentials from scratch and returns the biggest drift of the incrementally updated ones
+    double RecalculatePotentials();
+
+    Matrix<double> ToMatrix() const;
+  private:
+    bool IsRowNode(SizeType i_node) const;
+
+    SizeType ColumnNode(SizeType i_column) const;
+
+    PairOf<SizeType> CellOf(SizeType i_node, SizeType i_parent) const;
+
+    double CapacityOf(const PairOf<SizeType>& i_cell) const;
+
+    std::uint8_t& MaskOf(const PairOf<SizeType>& i_cell);
+
+    double& PotentialOf(SizeType i_node);
+
+    bool IsConnected();
+
+    SizeType AttachSubtree(SizeType i_subtree_root, SizeType i_after);
+
+    void LinkEdge(SizeType i_edge, SizeType i_first_node, SizeType i_second_node);
+
+    void PushHalfEdge(SizeType i_node, SizeType i_half_edge);
+
+    void UnlinkHalfEdge(SizeType i_node, SizeType i_half_edge);
+
+    SizeType FindHalfEdge(SizeType i_node, SizeType i_neighbour) const;
+
+    void CalculatePotentials();
+
+    const Matrix<double>& m_costs;
+    // Null for the tasks without capacities
+    const Matrix<double>* m_capacities;
+    SizeType m_rows_count;
+    SizeType m_columns_count;
+
+    Vector<SizeType>& m_parent;
+    Vector<SizeType>& m_depth;
+    Vector<SizeType>& m_thread;
+    Vector<SizeType>& m_reverse_thread;
+    Vector<double>& m_flow;
+    Vector<SizeType>& m_first_half_edge;
+    Vector<SizeType>& m_next_half_edge;
+    Vector<SizeType>& m_previous_half_edge;
+    Vector<SizeType>& m_half_edge_target;
+    Vector<std::uint8_t>& m_basis_mask;
+    MatrixPotentials& m_potentials;
+    MatrixPotentials& m_checked_potentials;
+
+    Vector<SizeType>& m_nodes_stack;
+    Vector<std::uint8_t>& m_visited;
+    Vector<CycleElement>& m_cycle;
+    SizeType m_entering_position = 0;
+  };
+}
@@ -0,0 +1,226 @@
+#include "pch.h"
+#include "CostScalingEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+
+namespace
+{
+  using namespace TransportTask;
+
+  using Price = std::int64_t;
+
+  constexpr Price epsilon_divisor = 16;
+  // Scaled costs stay below this bound, so prices fall far from the int64 limits
+  constexpr double max_scaled_cost = static_cast<double>(Price{ 1 } << 40);
+  constexpr double excess_tolerance = 1e-12;
+
+  // Arcs go from rows to columns with capacity min(resource, requirement), which no feasible flow exceeds,
+  // and back from columns to rows along the cells with flow. Reduced cost of the arc from u to v is
+  // cost + price[u] - price[v], arc is admissible if it is residual and its reduced cost is negative
+  class CostScalingNetwork
+  {
+  public:
+    CostScalingNetwork(const TransportInformation& i_data)
+      :m_resources{ i_data.m_resources }
+      ,m_requirements{ i_data.m_requirements }
+      ,m_rows_count{ i_data.m_resources.size() }
+      ,m_columns_count{ i_data.m_requirements.size() }
+      ,m_costs(m_rows_count, m_columns_count)
+      ,m_flows(m_rows_count, m_columns_count, 0.0)
+      ,m_prices(m_rows_count + m_columns_count, 0)
+      ,m_excess(m_rows_count + m_columns_count)
+      ,m_current_arc(m_rows_count + m_columns_count, 0)
+      ,m_is_queued(m_rows_count + m_columns_count, 0)
+    {
+      const auto& costs_matrix = i_data.m_costs_matrix;
+      double max_cost = 0.0;
+      bool is_integral = true;
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        for (double cost : costs_matrix[i])
+        {
+          max_cost = std::max(max_cost, std::abs(cost));
+          is_integral = is_integral && cost == std::floor(cost);
+        }
+      }
+      const Price nodes_multiplier = static_cast<Price>(m_rows_count + m_columns_count + 1);
+      const double cost_limit = max_scaled_cost / nodes_multiplier;
+      const double cost_factor = (!is_integral || max_cost > cost_limit) && max_cost > 0.0 ? cost_limit / max_cost : 1.0;
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        for (SizeType j = 0; j < m_columns_count; ++j)
+        {
+          m_costs[i][j] = std::llround(costs_matrix[i][j] * cost_factor) * nodes_multiplier;
+          m_max_cost = std::max(m_max_cost, std::abs(m_costs[i][j]));
+        }
+      }
+      double total_resources = 0.0;
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        m_excess[i] = m_resources[i];
+        total_resources += m_resources[i];
+      }
+      for (SizeType j = 0; j < m_columns_count; ++j)
+        m_excess[m_rows_count + j] = -m_requirements[j];
+      m_excess_tolerance = excess_tolerance * std::max(total_resources, 1.0);
+    }
+
+    Matrix<double> Solve()
+    {
+      Price epsilon = std::max(m_max_cost, Price{ 1 });
+      for (;;)
+      {
+        Refine(epsilon);
+        if (epsilon == 1)
+          break;
+        epsilon = std::max(epsilon / epsilon_divisor, Price{ 1 });
+      }
+      Matrix<double> plan(m_rows_count, m_columns_count, empty_value);
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        for (SizeType j = 0; j < m_columns_count; ++j)
+        {
+          if (m_flows[i][j] > m_excess_tolerance)
+            plan[i][j] = m_flows[i][j];
+        }
+      }
+      return plan;
+    }
+  private:
+    bool IsRowNode(SizeType i_node) const
+    {
+      return i_node < m_rows_count;
+    }
+
+    Price ReducedCost(SizeType i_row, SizeType i_column) const
+    {
+      return m_costs[i_row][i_column] + m_prices[i_row] - m_prices[m_rows_count + i_column];
+    }
+
+    double Capacity(SizeType i_row, SizeType i_column) const
+    {
+      return std::min(m_resources[i_row], m_requirements[i_column]);
+    }
+
+    // Positive amount goes from the row to the column, negative one goes back
+    void Push(SizeType i_row, SizeType i_column, double i_amount)
+    {
+      m_flows[i_row][i_column] += i_amount;
+      m_excess[i_row] -= i_amount;
+      m_excess[m_rows_count + i_column] += i_amount;
+    }
+
+    void Activate(SizeType i_node)
+    {
+      if (!m_is_queued[i_node] && m_excess[i_node] > m_excess_tolerance)
+      {
+        m_is_queued[i_node] = 1;
+        m_active_nodes.push_back(i_node);
+      }
+    }
+
+    // Saturating the arcs with negative reduced cost makes the flow 0-optimal, then excesses are discharged
+    void Refine(Price i_epsilon)
+    {
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        for (SizeType j = 0; j < m_columns_count; ++j)
+        {
+          const Price reduced_cost = ReducedCost(i, j);
+          if (reduced_cost < 0)
+            Push(i, j, Capacity(i, j) - m_flows[i][j]);
+          else if (reduced_cost > 0 && m_flows[i][j] > 0.0)
+            Push(i, j, -m_flows[i][j]);
+        }
+      }
+      std::fill(m_current_arc.begin(), m_current_arc.end(), 0);
+      for (SizeType node = 0; node < m_excess.size(); ++node)
+        Activate(node);
+      while (!m_active_nodes.empty())
+      {
+        const SizeType node = m_active_nodes.front();
+        m_active_nodes.pop_front();
+        m_is_queued[node] = 0;
+        Discharge(node, i_epsilon);
+      }
+    }
+
+    void Discharge(SizeType i_node, Price i_epsilon)
+    {
+      const bool is_row = IsRowNode(i_node);
+      const SizeType arcs_count = is_row ? m_columns_count : m_rows_count;
+      SizeType& arc = m_current_arc[i_node];
+      while (m_excess[i_node] > m_excess_tolerance)
+      {
+        if (arc == arcs_count)
+        {
+          Relabel(i_node, i_epsilon);
+          arc = 0;
+          continue;
+        }
+        const SizeType row = is_row ? i_node : arc;
+        const SizeType column = is_row ? arc : i_node - m_rows_count;
+        const double residual = is_row ? Capacity(row, column) - m_flows[row][column] : m_flows[row][column];
+        const Price reduced_cost = is_row ? ReducedCost(row, column) : -ReducedCost(row, column);
+        if (residual > 0.0 && reduced_cost < 0)
+        {
+          const double amount = std::min(m_excess[i_node], residual);
+          Push(row, column, is_row ? amount : -amount);
+          Activate(is_row ? m_rows_count + column : row);
+          if (amount < residual)
+            break;
+        }
+        ++arc;
+      }
+    }
+
+    // Price drops until some residual arc gets reduced cost -epsilon, others stay above it
+    void Relabel(SizeType i_node, Price i_epsilon)
+    {
+      Price new_price = std::numeric_limits<Price>::min();
+      if (IsRowNode(i_node))
+      {
+        for (SizeType j = 0; j < m_columns_count; ++j)
+        {
+          if (m_flows[i_node][j] < Capacity(i_node, j))
+            new_price = std::max(new_price, m_prices[m_rows_count + j] - m_costs[i_node][j]);
+        }
+      }
+      else
+      {
+        const SizeType column = i_node - m_rows_count;
+        for (SizeType i = 0; i < m_rows_count; ++i)
+        {
+          if (m_flows[i][column] > 0.0)
+            new_price = std::max(new_price, m_prices[i] + m_costs[i][column]);
+        }
+      }
+      m_prices[i_node] = new_price - i_epsilon;
+    }
+
+    const Vector<double>& m_resources;
+    const Vector<double>& m_requirements;
+    SizeType m_rows_count;
+    SizeType m_columns_count;
+    Matrix<Price> m_costs;
+    Price m_max_cost = 0;
+    Matrix<double> m_flows;
+    Vector<Price> m_prices;
+    Vector<double> m_excess;
+    double m_excess_tolerance = 0.0;
+    Vector<SizeType> m_current_arc;
+    Vector<std::uint8_t> m_is_queued;
+    std::deque<SizeType> m_active_nodes;
+  };
+}
+
+namespace TransportTask
+{
+  Matrix<double> SolveByCostScaling(const TransportInformation& i_data)
+  {
+    CostScalingNetwork network(i_data);
+    return network.Solve();
+  }
+}
\ No newline at end of file
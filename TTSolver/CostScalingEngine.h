@@ -0,0 +1,10 @@
+#pragma once
+#include "Utility.h"
+
+namespace TransportTask
+{
+  // Goldberg's cost scaling push-relabel over the bipartite network of the task. Costs are scaled to integers
+  // and multiplied by the nodes count, so 1-optimal flow of the last phase is optimal for the scaled costs;
+  // active nodes are discharged in FIFO order. Returns the plan, cells without flow keep empty_value
+  Matrix<double> SolveByCostScaling(const TransportInformation& i_data);
+}
\ No newline at end of file
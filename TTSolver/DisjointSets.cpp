@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "DisjointSets.h"
+#include <numeric>
+
+namespace TransportTask
+{
+  DisjointSets::DisjointSets(SizeType i_elements_count)
+    :m_parent(i_elements_count)
+    ,m_rank(i_elements_count, 0)
+    ,m_sets_count{ i_elements_count }
+  {
+    std::iota(m_parent.begin(), m_parent.end(), SizeType{ 0 });
+  }
+
+  SizeType DisjointSets::Find(SizeType i_element)
+  {
+    SizeType root = i_element;
+    while (m_parent[root] != root)
+      root = m_parent[root];
+    while (m_parent[i_element] != root)
+    {
+      const SizeType next = m_parent[i_element];
+      m_parent[i_element] = root;
+      i_element = next;
+    }
+    return root;
+  }
+
+  bool DisjointSets::Unite(SizeType i_first, SizeType i_second)
+  {
+    SizeType first_root = Find(i_first);
+    SizeType second_root = Find(i_second);
+    if (first_root == second_root)
+      return false;
+    if (m_rank[first_root] < m_rank[second_root])
+      std::swap(first_root, second_root);
+    m_parent[second_root] = first_root;
+    if (m_rank[first_root] == m_rank[second_root])
+      ++m_rank[first_root];
+    --m_sets_count;
+    return true;
+  }
+
+  SizeType DisjointSets::GetSetsCount() const
+  {
+    return m_sets_count;
+  }
+}
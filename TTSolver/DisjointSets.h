@@ -0,0 +1,23 @@
+#pragma once
+#include "Utility.h"
+
+namespace TransportTask
+{
+  // Union-find over rows [0, m) and columns [m, m + n) of the transport table
+  class DisjointSets
+  {
+  public:
+    explicit DisjointSets(SizeType i_elements_count);
+
+    SizeType Find(SizeType i_element);
+
+    // Returns false if both elements are already in the same set
+    bool Unite(SizeType i_first, SizeType i_second);
+
+    SizeType GetSetsCount() const;
+  private:
+    Vector<SizeType> m_parent;
+    Vector<SizeType> m_rank;
+    SizeType m_sets_count;
+  };
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace TransportTask
+{
+  template <typename T, std::size_t Alignment>
+  struct AlignedAllocator
+  {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t i_count)
+    {
+      return static_cast<T*>(::operator new(i_count * sizeof(T), std::align_val_t{ Alignment }));
+    }
+
+    void deallocate(T* i_pointer, std::size_t)
+    {
+      ::operator delete(i_pointer, std::align_val_t{ Alignment });
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+  };
+
+  template <typename T>
+  class RowView
+  {
+  public:
+    RowView(T* i_data, std::size_t i_size)
+      :m_data{ i_data }
+      ,m_size{ i_size }
+    {}
+
+    T& operator[](std::size_t i_index) const { return m_data[i_index]; }
+    T& front() const { return m_data[0]; }
+    T& back() const { return m_data[m_size - 1]; }
+    T* data() const { return m_data; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+    std::size_t size() const { return m_size; }
+  private:
+    T* m_data;
+    std::size_t m_size;
+  };
+
+  template <typename T>
+  class ColumnView
+  {
+  public:
+    ColumnView(T* i_data, std::size_t i_size, std::size_t i_stride)
+      :m_data{ i_data }
+      ,m_size{ i_size }
+      ,m_stride{ i_stride }
+    {}
+
+    T& operator[](std::size_t i_index) const { return m_data[i_index * m_stride]; }
+    std::size_t size() const { return m_size; }
+  private:
+    T* m_data;
+    std::size_t m_size;
+    std::size_t m_stride;
+  };
+
+  // Row-major matrix in one 64-byte aligned buffer, every row starts at a cache line boundary.
+  // Indexing and size()/front() follow the nested vectors it replaces, ToNested converts it back
+  template <typename T>
+  class Matrix
+  {
+    static_assert(!std::is_same_v<T, bool>, "Matrix<bool> can't expose rows as spans");
+  public:
+    static constexpr std::size_t alignment = 64;
+
+    Matrix() = default;
+
+    Matrix(std::size_t i_rows_count, std::size_t i_columns_count, const T& i_value = T{})
+      :m_rows_count{ i_rows_count }
+      ,m_columns_count{ i_columns_count }
+      ,m_row_stride{ AlignedStride(i_columns_count) }
+      ,m_elements(i_rows_count * AlignedStride(i_columns_count), i_value)
+    {}
+
+    Matrix(const std::vector<std::vector<T>>& i_nested)
+      :Matrix(i_nested.size(), i_nested.empty() ? 0 : i_nested.front().size())
+    {
+      for (std::size_t i = 0; i < m_rows_count; ++i)
+        std::copy(i_nested[i].cbegin(), i_nested[i].cend(), (*this)[i].begin());
+    }
+
+    std::vector<std::vector<T>> ToNested() const
+    {
+      std::vector<std::vector<T>> nested;
+      nested.reserve(m_rows_count);
+      for (std::size_t i = 0; i < m_rows_count; ++i)
+        nested.emplace_back((*this)[i].begin(), (*this)[i].end());
+      return nested;
+    }
+
+    std::size_t GetRowsCount() const { return m_rows_count; }
+    std::size_t GetColumnsCount() const { return m_columns_count; }
+    std::size_t GetRowStride() const { return m_row_stride; }
+    std::size_t size() const { return m_rows_count; }
+    bool empty() const { return m_rows_count == 0; }
+
+    RowView<T> operator[](std::size_t i_row) { return { m_elements.data() + i_row * m_row_stride, m_columns_count }; }
+    RowView<const T> operator[](std::size_t i_row) const { return { m_elements.data() + i_row * m_row_stride, m_columns_count }; }
+    RowView<T> front() { return (*this)[0]; }
+    RowView<const T> front() const { return (*this)[0]; }
+    RowView<T> back() { return (*this)[m_rows_count - 1]; }
+    RowView<const T> back() const { return (*this)[m_rows_count - 1]; }
+
+    ColumnView<T> Column(std::size_t i_column) { return { m_elements.data() + i_column, m_rows_count, m_row_stride }; }
+    ColumnView<const T> Column(std::size_t i_column) const { return { m_elements.data() + i_column, m_rows_count, m_row_stride }; }
+
+    T* data() { return m_elements.data(); }
+    const T* data() const { return m_elements.data(); }
+
+    bool operator==(const Matrix& i_other) const
+    {
+      if (m_rows_count != i_other.m_rows_count || m_columns_count != i_other.m_columns_count)
+        return false;
+      for (std::size_t i = 0; i < m_rows_count; ++i)
+      {
+        if (!std::equal((*this)[i].begin(), (*this)[i].end(), i_other[i].begin()))
+          return false;
+      }
+      return true;
+    }
+  private:
+    static std::size_t AlignedStride(std::size_t i_columns_count)
+    {
+      if constexpr (alignment % sizeof(T) == 0)
+      {
+        constexpr std::size_t elements_per_line = alignment / sizeof(T);
+        return (i_columns_count + elements_per_line - 1) / elements_per_line * elements_per_line;
+      }
+      else
+      {
+        return i_columns_count;
+      }
+    }
+
+    std::size_t m_rows_count = 0;
+    std::size_t m_columns_count = 0;
+    std::size_t m_row_stride = 0;
+    std::vector<T, AlignedAllocator<T, alignment>> m_elements;
+  };
+}
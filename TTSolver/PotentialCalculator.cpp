@@ -25,15 +25,15 @@ namespace
 
 namespace TransportTask
 {
-  std::optional<MatrixPotentials> TransportTask::CalculatePotentials(const TransportTask::TransportInformation& i_data, const Matrix<double>& i_solution_matrix)
+  std::optional<MatrixPotentials> CalculatePotentials(const TransportTask::TransportInformation& i_data, const Matrix<double>& i_solution_matrix)
   {
     const SizeType rows_count = i_data.m_resources.size();
     const SizeType columns_count = i_data.m_requirements.size();
     MatrixPotentials potentials(rows_count, columns_count);
-    Matrix<bool> visited(i_solution_matrix.size(), Vector<bool>(i_solution_matrix.front().size()));
+    Matrix<char> visited(i_solution_matrix.GetRowsCount(), i_solution_matrix.GetColumnsCount(), false);
     potentials.m_rows.front() = 0;
     std::queue<PairOf<SizeType>> processor_stack;
-    for (SizeType j = 0; j < i_solution_matrix.front().size(); ++j)
+    for (SizeType j = 0; j < columns_count; ++j)
     {
       if (i_solution_matrix.front()[j] != empty_value)
       {
@@ -48,15 +48,16 @@ namespace TransportTask
       {
         CalculatePotentialsAt(potentials, i_data.m_costs_matrix, { processed_row, processed_column });
         visited[processed_row][processed_column] = true;
-        for (SizeType row = 0; row < i_solution_matrix.size(); ++row)
+        const auto processed_column_cells = i_solution_matrix.Column(processed_column);
+        for (SizeType row = 0; row < rows_count; ++row)
         {
-          if (i_solution_matrix[row][processed_column] != empty_value && !visited[row][processed_column] && row != processed_row)
+          if (processed_column_cells[row] != empty_value && !visited[row][processed_column] && row != processed_row)
           {
             const auto current_element = std::make_pair(row, processed_column);
             processor_stack.push(current_element);
           }
         }
-        for (SizeType column = 0; column < i_solution_matrix[processed_row].size(); ++column)
+        for (SizeType column = 0; column < columns_count; ++column)
         {
           if (i_solution_matrix[processed_row][column] != empty_value && !visited[processed_row][column] && column != processed_column)
           {
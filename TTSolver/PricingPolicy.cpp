@@ -0,0 +1,461 @@
+#include "pch.h"
+#include "PricingPolicy.h"
+#include "BasisTree.h"
+#include "ReducedCostKernel.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+  using namespace TransportTask;
+
+  double ReducedCost(const Matrix<double>& i_costs, const MatrixPotentials& i_potentials, SizeType i_row, SizeType i_column)
+  {
+    return i_costs[i_row][i_column] - i_potentials.PotentialAt(i_row, i_column);
+  }
+
+  // Reduced cost of a cell without flow, negated one of a saturated cell which improves by decreasing its flow,
+  // so negative values improve the basis in both cases like the ones of FindRowMinimum
+  double Violation(double i_reduced_cost, std::uint8_t i_mask)
+  {
+    if (i_mask == basic_mask)
+      return 0.0;
+    return i_mask == upper_bound_mask ? -i_reduced_cost : i_reduced_cost;
+  }
+
+  double Violation(const Matrix<double>& i_costs, const BasisTree& i_basis, SizeType i_row, SizeType i_column)
+  {
+    return Violation(ReducedCost(i_costs, i_basis.GetPotentials(), i_row, i_column), i_basis.GetBasisMaskRow(i_row)[i_column]);
+  }
+
+  struct PricedCell
+  {
+    PairOf<SizeType> cell;
+    double reduced_cost = -potentials_tolerance;
+  };
+
+  // Total order of candidates, equal reduced costs are resolved by the position of the cell
+  bool IsMoreViolating(const PricedCell& i_lhs, const PricedCell& i_rhs)
+  {
+    return i_lhs.reduced_cost < i_rhs.reduced_cost || (i_lhs.reduced_cost == i_rhs.reduced_cost && i_lhs.cell < i_rhs.cell);
+  }
+
+  // Most violating cell of the rows range, cell is left unset if none of them violates potentiality
+  void PriceRows(const Matrix<double>& i_costs, const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row, PricedCell& io_best)
+  {
+    const auto& potentials = i_basis.GetPotentials();
+    const SizeType columns_count = i_basis.GetColumnsCount();
+    for (SizeType i = i_first_row; i < i_last_row; ++i)
+    {
+      const auto row_minimum = FindRowMinimum(i_costs[i].data(), i_basis.GetBasisMaskRow(i),
+                                              potentials.m_rows[i], potentials.m_columns.data(), columns_count);
+      if (row_minimum.reduced_cost < io_best.reduced_cost)
+      {
+        io_best.reduced_cost = row_minimum.reduced_cost;
+        io_best.cell = std::make_pair(i, row_minimum.column);
+      }
+    }
+  }
+
+  // Every violating non-basic cell of the rows range in rows order
+  void CollectViolating(const Matrix<double>& i_costs, const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row,
+                        Vector<PricedCell>& io_cells)
+  {
+    for (SizeType i = i_first_row; i < i_last_row; ++i)
+    {
+      for (SizeType j = 0; j < i_basis.GetColumnsCount(); ++j)
+      {
+        const double violation = Violation(i_costs, i_basis, i, j);
+        if (violation < -potentials_tolerance)
+          io_cells.push_back({ std::make_pair(i, j), violation });
+      }
+    }
+  }
+
+  // Splits the rows between the threads of the pool, partial results are reduced in rows order,
+  // so the selected cells don't depend on the amount of threads
+  class RowsPricer
+  {
+  public:
+    RowsPricer(ThreadPool* i_thread_pool)
+      :m_thread_pool{ i_thread_pool }
+    {}
+
+    PricedCell FindBest(const Matrix<double>& i_costs, const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row)
+    {
+      m_chunks_best.assign(GetChunksCount(i_basis, i_first_row, i_last_row), PricedCell{});
+      RunChunks(i_basis, i_first_row, i_last_row, [&](SizeType i_chunk, SizeType i_chunk_first_row, SizeType i_chunk_last_row)
+      {
+        PriceRows(i_costs, i_basis, i_chunk_first_row, i_chunk_last_row, m_chunks_best[i_chunk]);
+      });
+      PricedCell best;
+      for (const auto& chunk_best : m_chunks_best)
+      {
+        if (chunk_best.reduced_cost < best.reduced_cost)
+          best = chunk_best;
+      }
+      return best;
+    }
+
+    // Most violating cell of every row of the range, rows without violating cells keep the unset PricedCell
+    void FindRowMinima(const Matrix<double>& i_costs, const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row,
+                       Vector<PricedCell>& o_row_minima)
+    {
+      o_row_minima.assign(i_last_row - i_first_row, PricedCell{});
+      RunChunks(i_basis, i_first_row, i_last_row, [&](SizeType, SizeType i_chunk_first_row, SizeType i_chunk_last_row)
+      {
+        for (SizeType i = i_chunk_first_row; i < i_chunk_last_row; ++i)
+          PriceRows(i_costs, i_basis, i, i + 1, o_row_minima[i - i_first_row]);
+      });
+    }
+
+    void FindViolating(const Matrix<double>& i_costs, const BasisTree& i_basis, Vector<PricedCell>& o_cells)
+    {
+      o_cells.clear();
+      const SizeType rows_count = i_basis.GetRowsCount();
+      if (GetChunksCount(i_basis, 0, rows_count) == 1)
+      {
+        CollectViolating(i_costs, i_basis, 0, rows_count, o_cells);
+        return;
+      }
+      m_chunks_candidates.resize(GetChunksCount(i_basis, 0, rows_count));
+      RunChunks(i_basis, 0, rows_count, [&](SizeType i_chunk, SizeType i_chunk_first_row, SizeType i_chunk_last_row)
+      {
+        m_chunks_candidates[i_chunk].clear();
+        CollectViolating(i_costs, i_basis, i_chunk_first_row, i_chunk_last_row, m_chunks_candidates[i_chunk]);
+      });
+      for (const auto& chunk_cells : m_chunks_candidates)
+        o_cells.insert(o_cells.end(), chunk_cells.cbegin(), chunk_cells.cend());
+    }
+  private:
+    SizeType GetChunksCount(const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row) const
+    {
+      return GetRangesCount(m_thread_pool, i_last_row - i_first_row, i_basis.GetColumnsCount());
+    }
+
+    template <typename ChunkFunction>
+    void RunChunks(const BasisTree& i_basis, SizeType i_first_row, SizeType i_last_row, const ChunkFunction& i_function)
+    {
+      RunInRanges(m_thread_pool, i_last_row - i_first_row, i_basis.GetColumnsCount(), [&i_function, i_first_row](SizeType i_chunk, SizeType i_first, SizeType i_last)
+      {
+        i_function(i_chunk, i_first_row + i_first, i_first_row + i_last);
+      });
+    }
+
+    ThreadPool* m_thread_pool;
+    Vector<PricedCell> m_chunks_best;
+    Vector<Vector<PricedCell>> m_chunks_candidates;
+  };
+
+  class DantzigPricing : public PricingPolicy
+  {
+  public:
+    DantzigPricing(ThreadPool* i_thread_pool)
+      :m_pricer{ i_thread_pool }
+    {}
+
+    OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) override
+    {
+      const auto best = m_pricer.FindBest(i_costs, i_basis, 0, i_basis.GetRowsCount());
+      if (best.reduced_cost < -potentials_tolerance)
+        return best.cell;
+      return std::nullopt;
+    }
+  private:
+    RowsPricer m_pricer;
+  };
+
+  class FirstImprovingPricing : public PricingPolicy
+  {
+  public:
+    OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) override
+    {
+      const SizeType columns_count = i_basis.GetColumnsCount();
+      const SizeType cells_count = i_basis.GetRowsCount() * columns_count;
+      for (SizeType checked = 0; checked < cells_count; ++checked)
+      {
+        const SizeType i = m_position / columns_count;
+        const SizeType j = m_position % columns_count;
+        m_position = m_position + 1 == cells_count ? 0 : m_position + 1;
+        if (Violation(i_costs, i_basis, i, j) < -potentials_tolerance)
+          return std::make_pair(i, j);
+      }
+      return std::nullopt;
+    }
+  private:
+    SizeType m_position = 0;
+  };
+
+  class BlockSearchPricing : public PricingPolicy
+  {
+  public:
+    BlockSearchPricing(SizeType i_block_rows_count, ThreadPool* i_thread_pool)
+      :m_block_rows_count{ i_block_rows_count }
+      ,m_pricer{ i_thread_pool }
+    {}
+
+    OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) override
+    {
+      const SizeType rows_count = i_basis.GetRowsCount();
+      for (SizeType scanned_rows = 0; scanned_rows < rows_count; scanned_rows += m_block_rows_count)
+      {
+        const SizeType last_row = std::min(m_first_row + m_block_rows_count, rows_count);
+        const auto best = m_pricer.FindBest(i_costs, i_basis, m_first_row, last_row);
+        m_first_row = last_row == rows_count ? 0 : last_row;
+        if (best.reduced_cost < -potentials_tolerance)
+          return best.cell;
+      }
+      return std::nullopt;
+    }
+  private:
+    SizeType m_block_rows_count;
+    SizeType m_first_row = 0;
+    RowsPricer m_pricer;
+  };
+
+  // Candidates are refreshed from blocks of rows starting where the previous refresh stopped, every row gives its most
+  // violating cell, so a refresh prices only the rows needed to fill the list
+  class CandidateListPricing : public PricingPolicy
+  {
+  public:
+    CandidateListPricing(SizeType i_list_size, ThreadPool* i_thread_pool)
+      :m_list_size{ i_list_size }
+      ,m_minor_iterations_limit{ i_list_size / 4 + 1 }
+      ,m_pricer{ i_thread_pool }
+    {
+      m_candidates.reserve(2 * i_list_size);
+      m_row_minima.reserve(i_list_size);
+    }
+
+    OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) override
+    {
+      if (m_minor_iterations < m_minor_iterations_limit)
+      {
+        if (auto entering = SelectFromCandidates(i_costs, i_basis); entering)
+          return entering;
+      }
+      RefreshCandidates(i_costs, i_basis);
+      m_minor_iterations = 0;
+      return SelectFromCandidates(i_costs, i_basis);
+    }
+  private:
+    void RefreshCandidates(const Matrix<double>& i_costs, const BasisTree& i_basis)
+    {
+      m_candidates.clear();
+      const SizeType rows_count = i_basis.GetRowsCount();
+      for (SizeType scanned_rows = 0; scanned_rows < rows_count && m_candidates.size() < m_list_size; scanned_rows += m_list_size)
+      {
+        const SizeType last_row = std::min(m_first_row + m_list_size, rows_count);
+        m_pricer.FindRowMinima(i_costs, i_basis, m_first_row, last_row, m_row_minima);
+        for (const auto& row_minimum : m_row_minima)
+        {
+          if (row_minimum.reduced_cost < -potentials_tolerance)
+            m_candidates.push_back(row_minimum);
+        }
+        m_first_row = last_row == rows_count ? 0 : last_row;
+      }
+      if (m_candidates.size() > m_list_size)
+      {
+        std::nth_element(m_candidates.begin(), m_candidates.begin() + m_list_size, m_candidates.end(), IsMoreViolating);
+        m_candidates.resize(m_list_size);
+      }
+    }
+
+    OptionalPair<SizeType> SelectFromCandidates(const Matrix<double>& i_costs, const BasisTree& i_basis)
+    {
+      auto first_invalid = std::remove_if(m_candidates.begin(), m_candidates.end(), [&](PricedCell& candidate)
+      {
+        auto [row, column] = candidate.cell;
+        candidate.reduced_cost = Violation(i_costs, i_basis, row, column);
+        return candidate.reduced_cost >= -potentials_tolerance;
+      });
+      m_candidates.erase(first_invalid, m_candidates.end());
+      if (m_candidates.empty())
+        return std::nullopt;
+      ++m_minor_iterations;
+      return std::min_element(m_candidates.cbegin(), m_candidates.cend(), IsMoreViolating)->cell;
+    }
+
+    SizeType m_list_size;
+    SizeType m_minor_iterations_limit;
+    SizeType m_minor_iterations = 0;
+    SizeType m_first_row = 0;
+    Vector<PricedCell> m_candidates;
+    Vector<PricedCell> m_row_minima;
+    RowsPricer m_pricer;
+  };
+
+  // Arcs keep their costs, so the restricted pricing reads a compact list sorted by rows instead of the cost matrix
+  class RestrictedArcsPricing : public PricingPolicy
+  {
+  public:
+    RestrictedArcsPricing(SizeType i_arcs_per_line, ThreadPool* i_thread_pool)
+      :m_arcs_per_line{ i_arcs_per_line }
+      ,m_pricer{ i_thread_pool }
+    {}
+
+    OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) override
+    {
+      if (m_arcs.empty())
+        CollectCheapestArcs(i_costs);
+      if (auto entering = SelectFromArcs(i_basis); entering)
+        return entering;
+      m_pricer.FindViolating(i_costs, i_basis, m_violating_cells);
+      if (m_violating_cells.empty())
+        return std::nullopt;
+      // Violating cells can't be among the arcs, otherwise the restricted pricing would have found them. They come in
+      // rows order, so they are merged from the back into the grown list without a temporary buffer
+      SizeType arc = m_arcs.size();
+      SizeType violating = m_violating_cells.size();
+      m_arcs.resize(arc + violating);
+      for (SizeType position = m_arcs.size(); violating != 0;)
+      {
+        auto [row, column] = m_violating_cells[violating - 1].cell;
+        const Arc violating_arc{ i_costs[row][column], static_cast<std::uint32_t>(row), static_cast<std::uint32_t>(column) };
+        if (arc != 0 && IsArcBefore(violating_arc, m_arcs[arc - 1]))
+        {
+          m_arcs[--position] = m_arcs[--arc];
+        }
+        else
+        {
+          m_arcs[--position] = violating_arc;
+          --violating;
+        }
+      }
+      return std::min_element(m_violating_cells.cbegin(), m_violating_cells.cend(), IsMoreViolating)->cell;
+    }
+  private:
+    struct Arc
+    {
+      double cost;
+      std::uint32_t row;
+      std::uint32_t column;
+    };
+
+    static bool IsArcBefore(const Arc& i_lhs, const Arc& i_rhs)
+    {
+      return i_lhs.row < i_rhs.row || (i_lhs.row == i_rhs.row && i_lhs.column < i_rhs.column);
+    }
+
+    void CollectCheapestArcs(const Matrix<double>& i_costs)
+    {
+      const SizeType rows_count = i_costs.GetRowsCount();
+      const SizeType columns_count = i_costs.GetColumnsCount();
+      Vector<SizeType> line;
+      auto take_cheapest = [this, &line](auto i_cost_of, auto i_cell_of)
+      {
+        const SizeType taken_count = std::min(m_arcs_per_line, line.size());
+        std::nth_element(line.begin(), line.begin() + (taken_count - 1), line.end(), [&i_cost_of](SizeType lhs, SizeType rhs)
+        {
+          return i_cost_of(lhs) < i_cost_of(rhs) || (i_cost_of(lhs) == i_cost_of(rhs) && lhs < rhs);
+        });
+        for (SizeType k = 0; k < taken_count; ++k)
+          m_arcs.push_back(i_cell_of(line[k]));
+      };
+      line.resize(columns_count);
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        for (SizeType j = 0; j < columns_count; ++j)
+          line[j] = j;
+        take_cheapest([&i_costs, i](SizeType j) { return i_costs[i][j]; },
+                      [&i_costs, i](SizeType j) { return Arc{ i_costs[i][j], static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j) }; });
+      }
+      line.resize(rows_count);
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        for (SizeType i = 0; i < rows_count; ++i)
+          line[i] = i;
+        take_cheapest([&i_costs, j](SizeType i) { return i_costs[i][j]; },
+                      [&i_costs, j](SizeType i) { return Arc{ i_costs[i][j], static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j) }; });
+      }
+      std::sort(m_arcs.begin(), m_arcs.end(), IsArcBefore);
+      m_arcs.erase(std::unique(m_arcs.begin(), m_arcs.end(), [](const Arc& lhs, const Arc& rhs)
+      {
+        return lhs.row == rhs.row && lhs.column == rhs.column;
+      }), m_arcs.end());
+    }
+
+    OptionalPair<SizeType> SelectFromArcs(const BasisTree& i_basis) const
+    {
+      const auto& potentials = i_basis.GetPotentials();
+      PricedCell best;
+      for (const auto& arc : m_arcs)
+      {
+        const double violation = Violation(arc.cost - potentials.m_rows[arc.row] - potentials.m_columns[arc.column],
+                                           i_basis.GetBasisMaskRow(arc.row)[arc.column]);
+        if (violation < best.reduced_cost)
+          best = { std::make_pair(SizeType{ arc.row }, SizeType{ arc.column }), violation };
+      }
+      if (best.reduced_cost < -potentials_tolerance)
+        return best.cell;
+      return std::nullopt;
+    }
+
+    SizeType m_arcs_per_line;
+    Vector<Arc> m_arcs;
+    Vector<PricedCell> m_violating_cells;
+    RowsPricer m_pricer;
+  };
+
+  SizeType DefaultBlockRowsCount(SizeType i_rows_count, SizeType i_columns_count)
+  {
+    const double cells_per_block = std::sqrt(static_cast<double>(i_rows_count * i_columns_count));
+    return std::max<SizeType>(1, static_cast<SizeType>(cells_per_block / i_columns_count));
+  }
+
+  SizeType DefaultCandidateListSize(SizeType i_rows_count, SizeType i_columns_count)
+  {
+    const double cells_count = static_cast<double>(i_rows_count * i_columns_count);
+    return std::max<SizeType>(16, static_cast<SizeType>(std::sqrt(cells_count) / 4));
+  }
+
+  SizeType DefaultRestrictedArcsPerLine(SizeType i_rows_count, SizeType i_columns_count)
+  {
+    return std::max<SizeType>(4, static_cast<SizeType>(std::log2(static_cast<double>(i_rows_count + i_columns_count))));
+  }
+}
+
+namespace TransportTask
+{
+  std::string GetPricingName(PricingRule i_rule)
+  {
+    switch (i_rule)
+    {
+    case PricingRule::Dantzig:
+      return "Dantzig";
+    case PricingRule::FirstImproving:
+      return "First improving";
+    case PricingRule::BlockSearch:
+      return "Block search";
+    case PricingRule::CandidateList:
+      return "Candidate list";
+    case PricingRule::RestrictedArcs:
+      return "Restricted arcs";
+    }
+    throw std::runtime_error{ "Undefined pricing rule" };
+  }
+
+  std::unique_ptr<PricingPolicy> CreatePricingPolicy(const PricingSettings& i_settings, SizeType i_rows_count, SizeType i_columns_count, ThreadPool* i_thread_pool)
+  {
+    switch (i_settings.rule)
+    {
+    case PricingRule::Dantzig:
+      return std::make_unique<DantzigPricing>(i_thread_pool);
+    case PricingRule::FirstImproving:
+      return std::make_unique<FirstImprovingPricing>();
+    case PricingRule::BlockSearch:
+      return std::make_unique<BlockSearchPricing>(i_settings.block_rows_count != 0
+        ? i_settings.block_rows_count : DefaultBlockRowsCount(i_rows_count, i_columns_count), i_thread_pool);
+    case PricingRule::CandidateList:
+      return std::make_unique<CandidateListPricing>(i_settings.candidate_list_size != 0
+        ? i_settings.candidate_list_size : DefaultCandidateListSize(i_rows_count, i_columns_count), i_thread_pool);
+    case PricingRule::RestrictedArcs:
+      return std::make_unique<RestrictedArcsPricing>(i_settings.restricted_arcs_per_line != 0
+        ? i_settings.restricted_arcs_per_line : DefaultRestrictedArcsPerLine(i_rows_count, i_columns_count), i_thread_pool);
+    }
+    throw std::runtime_error{ "Undefined pricing rule" };
+  }
+}
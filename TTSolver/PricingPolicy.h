@@ -0,0 +1,42 @@
+#pragma once
+#include "Utility.h"
+#include "ExportHeader.h"
+#include <memory>
+#include <string>
+
+class ThreadPool;
+
+namespace TransportTask
+{
+  class BasisTree;
+
+  // RestrictedArcs prices only the cheapest cells of every line and the cells added by full pricing, the full matrix is
+  // priced when none of them violates and the violating cells join the priced ones, so the optimum stays exact
+  enum class PricingRule { Dantzig, FirstImproving, BlockSearch, CandidateList, RestrictedArcs, LAST };
+
+  SOLVER_API std::string GetPricingName(PricingRule i_rule);
+
+  struct PricingSettings
+  {
+    PricingRule rule = PricingRule::Dantzig;
+    // Zero picks the value from the size of the task
+    SizeType block_rows_count = 0;
+    SizeType candidate_list_size = 0;
+    // Cheapest cells of every row and every column the restricted arcs start with
+    SizeType restricted_arcs_per_line = 0;
+  };
+
+  // Selects the non-basic cell entering the basis, nullopt means that no such cell improves the basis. Saturated cells
+  // of capacitated tasks are priced together with the cells without flow, their reduced costs have the opposite sign
+  class PricingPolicy
+  {
+  public:
+    virtual ~PricingPolicy() = default;
+
+    virtual OptionalPair<SizeType> SelectEntering(const Matrix<double>& i_costs, const BasisTree& i_basis) = 0;
+  };
+
+  // Pricing of full rows is split between the threads of the pool if it is given
+  std::unique_ptr<PricingPolicy> CreatePricingPolicy(const PricingSettings& i_settings, SizeType i_rows_count, SizeType i_columns_count,
+                                                     ThreadPool* i_thread_pool = nullptr);
+}
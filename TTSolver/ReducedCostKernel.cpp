@@ -0,0 +1,493 @@
+#include "pch.h"
+#include "ReducedCostKernel.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define KERNEL_X86
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    #define KERNEL_TARGET(instruction_set)
+  #else
+    #define KERNEL_TARGET(instruction_set) __attribute__((target(instruction_set)))
+  #endif
+#endif
+
+namespace
+{
+  using namespace TransportTask;
+
+  using RowKernel = ReducedCostMinimum(*)(const double*, const std::uint8_t*, double, const double*, SizeType);
+  using PriceKernel = double(*)(const double*, const double*, SizeType);
+  using DotKernel = double(*)(const double*, const double*, SizeType);
+  using ScaledRowKernel = void(*)(double*, const double*, double, SizeType);
+
+  constexpr SizeType price_lanes_count = 8;
+
+  double ReducePriceLanes(const double (&i_lanes)[price_lanes_count], const double* i_flows, const double* i_costs,
+                          SizeType i_first_column, SizeType i_columns_count)
+  {
+    double price = ((i_lanes[0] + i_lanes[1]) + (i_lanes[2] + i_lanes[3])) + ((i_lanes[4] + i_lanes[5]) + (i_lanes[6] + i_lanes[7]));
+    for (SizeType j = i_first_column; j < i_columns_count; ++j)
+    {
+      if (i_flows[j] != empty_value)
+        price += i_flows[j] * i_costs[j];
+    }
+    return price;
+  }
+
+  double ScalarRowPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count)
+  {
+    double lanes[price_lanes_count] = {};
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_columns_count; j += price_lanes_count)
+    {
+      for (SizeType lane = 0; lane < price_lanes_count; ++lane)
+      {
+        if (i_flows[j + lane] != empty_value)
+          lanes[lane] += i_flows[j + lane] * i_costs[j + lane];
+      }
+    }
+    return ReducePriceLanes(lanes, i_flows, i_costs, j, i_columns_count);
+  }
+
+  double ReduceDotLanes(const double (&i_lanes)[price_lanes_count], const double* i_lhs, const double* i_rhs,
+                        SizeType i_first, SizeType i_count)
+  {
+    double sum = ((i_lanes[0] + i_lanes[1]) + (i_lanes[2] + i_lanes[3])) + ((i_lanes[4] + i_lanes[5]) + (i_lanes[6] + i_lanes[7]));
+    for (SizeType j = i_first; j < i_count; ++j)
+      sum += i_lhs[j] * i_rhs[j];
+    return sum;
+  }
+
+  double ScalarDotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count)
+  {
+    double lanes[price_lanes_count] = {};
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_count; j += price_lanes_count)
+    {
+      for (SizeType lane = 0; lane < price_lanes_count; ++lane)
+        lanes[lane] += i_lhs[j + lane] * i_rhs[j + lane];
+    }
+    return ReduceDotLanes(lanes, i_lhs, i_rhs, j, i_count);
+  }
+
+  void ScalarAddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count)
+  {
+    for (SizeType j = 0; j < i_count; ++j)
+      io_sums[j] += i_scale * i_row[j];
+  }
+
+  void UpdateMinimum(ReducedCostMinimum& io_minimum, double i_reduced_cost, SizeType i_column)
+  {
+    if (i_reduced_cost < io_minimum.reduced_cost || (i_reduced_cost == io_minimum.reduced_cost && i_column < io_minimum.column))
+    {
+      io_minimum.reduced_cost = i_reduced_cost;
+      io_minimum.column = i_column;
+    }
+  }
+
+  void ScanTail(ReducedCostMinimum& io_minimum, const double* i_costs, const std::uint8_t* i_basis_mask,
+                double i_row_potential, const double* i_column_potentials, SizeType i_first_column, SizeType i_columns_count)
+  {
+    for (SizeType j = i_first_column; j < i_columns_count; ++j)
+    {
+      const double reduced_cost = (i_costs[j] - i_row_potential) - i_column_potentials[j];
+      const double violation = i_basis_mask[j] == upper_bound_mask ? -reduced_cost : reduced_cost;
+      if (i_basis_mask[j] != basic_mask && violation < io_minimum.reduced_cost)
+      {
+        io_minimum.reduced_cost = violation;
+        io_minimum.column = j;
+      }
+    }
+  }
+
+  // Lanes keep the first minimum of their own columns, so reducing them by (value, column) reproduces the scalar scan
+  template <SizeType LanesCount>
+  ReducedCostMinimum ReduceLanes(const double (&i_values)[LanesCount], const double (&i_columns)[LanesCount])
+  {
+    ReducedCostMinimum minimum;
+    for (SizeType lane = 0; lane < LanesCount; ++lane)
+    {
+      if (i_columns[lane] >= 0.0)
+        UpdateMinimum(minimum, i_values[lane], static_cast<SizeType>(i_columns[lane]));
+    }
+    return minimum;
+  }
+
+  ReducedCostMinimum ScalarRowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                      double i_row_potential, const double* i_column_potentials, SizeType i_columns_count)
+  {
+    ReducedCostMinimum minimum;
+    ScanTail(minimum, i_costs, i_basis_mask, i_row_potential, i_column_potentials, 0, i_columns_count);
+    return minimum;
+  }
+
+#ifdef KERNEL_X86
+  ReducedCostMinimum SSE2RowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                    double i_row_potential, const double* i_column_potentials, SizeType i_columns_count)
+  {
+    const __m128d row_potential = _mm_set1_pd(i_row_potential);
+    const __m128d sign_bit = _mm_set1_pd(-0.0);
+    const __m128d step = _mm_set1_pd(2.0);
+    __m128d best_values = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d best_columns = _mm_set1_pd(-1.0);
+    __m128d columns = _mm_set_pd(1.0, 0.0);
+    SizeType j = 0;
+    for (; j + 2 <= i_columns_count; j += 2)
+    {
+      const __m128d reduced_costs = _mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(i_costs + j), row_potential), _mm_loadu_pd(i_column_potentials + j));
+      const __m128d is_free = _mm_castsi128_pd(_mm_set_epi64x(i_basis_mask[j + 1] != basic_mask ? -1 : 0, i_basis_mask[j] != basic_mask ? -1 : 0));
+      const __m128d is_upper = _mm_castsi128_pd(_mm_set_epi64x(i_basis_mask[j + 1] == upper_bound_mask ? -1 : 0,
+                                                               i_basis_mask[j] == upper_bound_mask ? -1 : 0));
+      const __m128d violations = _mm_xor_pd(reduced_costs, _mm_and_pd(is_upper, sign_bit));
+      const __m128d is_better = _mm_and_pd(is_free, _mm_cmplt_pd(violations, best_values));
+      best_values = _mm_or_pd(_mm_and_pd(is_better, violations), _mm_andnot_pd(is_better, best_values));
+      best_columns = _mm_or_pd(_mm_and_pd(is_better, columns), _mm_andnot_pd(is_better, best_columns));
+      columns = _mm_add_pd(columns, step);
+    }
+    double values[2], best_indexes[2];
+    _mm_storeu_pd(values, best_values);
+    _mm_storeu_pd(best_indexes, best_columns);
+    auto minimum = ReduceLanes(values, best_indexes);
+    ScanTail(minimum, i_costs, i_basis_mask, i_row_potential, i_column_potentials, j, i_columns_count);
+    return minimum;
+  }
+
+  double SSE2RowPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count)
+  {
+    const __m128d empty = _mm_set1_pd(empty_value);
+    __m128d sums[4] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_columns_count; j += price_lanes_count)
+    {
+      for (SizeType part = 0; part < 4; ++part)
+      {
+        const __m128d flows = _mm_loadu_pd(i_flows + j + 2 * part);
+        const __m128d prices = _mm_mul_pd(flows, _mm_loadu_pd(i_costs + j + 2 * part));
+        sums[part] = _mm_add_pd(sums[part], _mm_and_pd(_mm_cmpneq_pd(flows, empty), prices));
+      }
+    }
+    double lanes[price_lanes_count];
+    for (SizeType part = 0; part < 4; ++part)
+      _mm_storeu_pd(lanes + 2 * part, sums[part]);
+    return ReducePriceLanes(lanes, i_flows, i_costs, j, i_columns_count);
+  }
+
+  double SSE2DotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count)
+  {
+    __m128d sums[4] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_count; j += price_lanes_count)
+    {
+      for (SizeType part = 0; part < 4; ++part)
+        sums[part] = _mm_add_pd(sums[part], _mm_mul_pd(_mm_loadu_pd(i_lhs + j + 2 * part), _mm_loadu_pd(i_rhs + j + 2 * part)));
+    }
+    double lanes[price_lanes_count];
+    for (SizeType part = 0; part < 4; ++part)
+      _mm_storeu_pd(lanes + 2 * part, sums[part]);
+    return ReduceDotLanes(lanes, i_lhs, i_rhs, j, i_count);
+  }
+
+  void SSE2AddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count)
+  {
+    const __m128d scale = _mm_set1_pd(i_scale);
+    SizeType j = 0;
+    for (; j + 2 <= i_count; j += 2)
+      _mm_storeu_pd(io_sums + j, _mm_add_pd(_mm_loadu_pd(io_sums + j), _mm_mul_pd(scale, _mm_loadu_pd(i_row + j))));
+    ScalarAddScaledRow(io_sums + j, i_row + j, i_scale, i_count - j);
+  }
+
+  KERNEL_TARGET("avx2")
+  double AVX2DotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count)
+  {
+    __m256d low_sums = _mm256_setzero_pd();
+    __m256d high_sums = _mm256_setzero_pd();
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_count; j += price_lanes_count)
+    {
+      low_sums = _mm256_add_pd(low_sums, _mm256_mul_pd(_mm256_loadu_pd(i_lhs + j), _mm256_loadu_pd(i_rhs + j)));
+      high_sums = _mm256_add_pd(high_sums, _mm256_mul_pd(_mm256_loadu_pd(i_lhs + j + 4), _mm256_loadu_pd(i_rhs + j + 4)));
+    }
+    double lanes[price_lanes_count];
+    _mm256_storeu_pd(lanes, low_sums);
+    _mm256_storeu_pd(lanes + 4, high_sums);
+    return ReduceDotLanes(lanes, i_lhs, i_rhs, j, i_count);
+  }
+
+  KERNEL_TARGET("avx2")
+  void AVX2AddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count)
+  {
+    const __m256d scale = _mm256_set1_pd(i_scale);
+    SizeType j = 0;
+    for (; j + 4 <= i_count; j += 4)
+      _mm256_storeu_pd(io_sums + j, _mm256_add_pd(_mm256_loadu_pd(io_sums + j), _mm256_mul_pd(scale, _mm256_loadu_pd(i_row + j))));
+    ScalarAddScaledRow(io_sums + j, i_row + j, i_scale, i_count - j);
+  }
+
+  KERNEL_TARGET("avx512f")
+  double AVX512DotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count)
+  {
+    __m512d sums = _mm512_setzero_pd();
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_count; j += price_lanes_count)
+      sums = _mm512_add_pd(sums, _mm512_mul_pd(_mm512_loadu_pd(i_lhs + j), _mm512_loadu_pd(i_rhs + j)));
+    double lanes[price_lanes_count];
+    _mm512_storeu_pd(lanes, sums);
+    return ReduceDotLanes(lanes, i_lhs, i_rhs, j, i_count);
+  }
+
+  KERNEL_TARGET("avx512f")
+  void AVX512AddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count)
+  {
+    const __m512d scale = _mm512_set1_pd(i_scale);
+    SizeType j = 0;
+    for (; j + 8 <= i_count; j += 8)
+      _mm512_storeu_pd(io_sums + j, _mm512_add_pd(_mm512_loadu_pd(io_sums + j), _mm512_mul_pd(scale, _mm512_loadu_pd(i_row + j))));
+    ScalarAddScaledRow(io_sums + j, i_row + j, i_scale, i_count - j);
+  }
+
+  KERNEL_TARGET("avx2")
+  double AVX2RowPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count)
+  {
+    const __m256d empty = _mm256_set1_pd(empty_value);
+    __m256d low_sums = _mm256_setzero_pd();
+    __m256d high_sums = _mm256_setzero_pd();
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_columns_count; j += price_lanes_count)
+    {
+      const __m256d low_flows = _mm256_loadu_pd(i_flows + j);
+      const __m256d high_flows = _mm256_loadu_pd(i_flows + j + 4);
+      const __m256d low_prices = _mm256_mul_pd(low_flows, _mm256_loadu_pd(i_costs + j));
+      const __m256d high_prices = _mm256_mul_pd(high_flows, _mm256_loadu_pd(i_costs + j + 4));
+      low_sums = _mm256_add_pd(low_sums, _mm256_and_pd(_mm256_cmp_pd(low_flows, empty, _CMP_NEQ_OQ), low_prices));
+      high_sums = _mm256_add_pd(high_sums, _mm256_and_pd(_mm256_cmp_pd(high_flows, empty, _CMP_NEQ_OQ), high_prices));
+    }
+    double lanes[price_lanes_count];
+    _mm256_storeu_pd(lanes, low_sums);
+    _mm256_storeu_pd(lanes + 4, high_sums);
+    return ReducePriceLanes(lanes, i_flows, i_costs, j, i_columns_count);
+  }
+
+  KERNEL_TARGET("avx512f")
+  double AVX512RowPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count)
+  {
+    const __m512d empty = _mm512_set1_pd(empty_value);
+    __m512d sums = _mm512_setzero_pd();
+    SizeType j = 0;
+    for (; j + price_lanes_count <= i_columns_count; j += price_lanes_count)
+    {
+      const __m512d flows = _mm512_loadu_pd(i_flows + j);
+      const __m512d prices = _mm512_mul_pd(flows, _mm512_loadu_pd(i_costs + j));
+      sums = _mm512_mask_add_pd(sums, _mm512_cmp_pd_mask(flows, empty, _CMP_NEQ_OQ), sums, prices);
+    }
+    double lanes[price_lanes_count];
+    _mm512_storeu_pd(lanes, sums);
+    return ReducePriceLanes(lanes, i_flows, i_costs, j, i_columns_count);
+  }
+
+  KERNEL_TARGET("avx2")
+  ReducedCostMinimum AVX2RowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                    double i_row_potential, const double* i_column_potentials, SizeType i_columns_count)
+  {
+    const __m256d row_potential = _mm256_set1_pd(i_row_potential);
+    const __m256d sign_bit = _mm256_set1_pd(-0.0);
+    const __m256i basic = _mm256_set1_epi64x(basic_mask);
+    const __m256i upper_bound = _mm256_set1_epi64x(upper_bound_mask);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d best_values = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d best_columns = _mm256_set1_pd(-1.0);
+    __m256d columns = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    SizeType j = 0;
+    for (; j + 4 <= i_columns_count; j += 4)
+    {
+      const __m256d reduced_costs = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(i_costs + j), row_potential), _mm256_loadu_pd(i_column_potentials + j));
+      std::int32_t mask_bytes;
+      std::memcpy(&mask_bytes, i_basis_mask + j, sizeof(mask_bytes));
+      const __m256i mask = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(mask_bytes));
+      const __m256d is_basic = _mm256_castsi256_pd(_mm256_cmpeq_epi64(mask, basic));
+      const __m256d is_upper = _mm256_castsi256_pd(_mm256_cmpeq_epi64(mask, upper_bound));
+      const __m256d violations = _mm256_xor_pd(reduced_costs, _mm256_and_pd(is_upper, sign_bit));
+      const __m256d is_better = _mm256_andnot_pd(is_basic, _mm256_cmp_pd(violations, best_values, _CMP_LT_OQ));
+      best_values = _mm256_blendv_pd(best_values, violations, is_better);
+      best_columns = _mm256_blendv_pd(best_columns, columns, is_better);
+      columns = _mm256_add_pd(columns, step);
+    }
+    double values[4], best_indexes[4];
+    _mm256_storeu_pd(values, best_values);
+    _mm256_storeu_pd(best_indexes, best_columns);
+    auto minimum = ReduceLanes(values, best_indexes);
+    ScanTail(minimum, i_costs, i_basis_mask, i_row_potential, i_column_potentials, j, i_columns_count);
+    return minimum;
+  }
+
+  KERNEL_TARGET("avx512f")
+  ReducedCostMinimum AVX512RowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                      double i_row_potential, const double* i_column_potentials, SizeType i_columns_count)
+  {
+    const __m512d row_potential = _mm512_set1_pd(i_row_potential);
+    const __m512i sign_bit = _mm512_set1_epi64(std::numeric_limits<std::int64_t>::min());
+    const __m512i basic = _mm512_set1_epi64(basic_mask);
+    const __m512i upper_bound = _mm512_set1_epi64(upper_bound_mask);
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d best_values = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d best_columns = _mm512_set1_pd(-1.0);
+    __m512d columns = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    SizeType j = 0;
+    for (; j + 8 <= i_columns_count; j += 8)
+    {
+      const __m512d reduced_costs = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(i_costs + j), row_potential), _mm512_loadu_pd(i_column_potentials + j));
+      // Zero-masked widening, the unmasked one merges into an undefined register
+      const __m512i mask = _mm512_maskz_cvtepu8_epi64(0xFF, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(i_basis_mask + j)));
+      const __mmask8 is_free = _mm512_cmpneq_epi64_mask(mask, basic);
+      const __mmask8 is_upper = _mm512_cmpeq_epi64_mask(mask, upper_bound);
+      const __m512i reduced_costs_bits = _mm512_castpd_si512(reduced_costs);
+      const __m512d violations = _mm512_castsi512_pd(_mm512_mask_xor_epi64(reduced_costs_bits, is_upper, reduced_costs_bits, sign_bit));
+      const __mmask8 is_better = _mm512_mask_cmp_pd_mask(is_free, violations, best_values, _CMP_LT_OQ);
+      best_values = _mm512_mask_mov_pd(best_values, is_better, violations);
+      best_columns = _mm512_mask_mov_pd(best_columns, is_better, columns);
+      columns = _mm512_add_pd(columns, step);
+    }
+    double values[8], best_indexes[8];
+    _mm512_storeu_pd(values, best_values);
+    _mm512_storeu_pd(best_indexes, best_columns);
+    auto minimum = ReduceLanes(values, best_indexes);
+    ScanTail(minimum, i_costs, i_basis_mask, i_row_potential, i_column_potentials, j, i_columns_count);
+    return minimum;
+  }
+
+  KernelInstructionSet DetectInstructionSet()
+  {
+#if defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    const int max_leaf = registers[0];
+    __cpuidex(registers, 1, 0);
+    const bool has_os_avx = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0;
+    if (!has_os_avx || max_leaf < 7)
+      return KernelInstructionSet::SSE2;
+    const unsigned long long enabled_states = _xgetbv(0);
+    __cpuidex(registers, 7, 0);
+    if ((registers[1] & (1 << 16)) != 0 && (enabled_states & 0xE6) == 0xE6)
+      return KernelInstructionSet::AVX512;
+    if ((registers[1] & (1 << 5)) != 0 && (enabled_states & 0x6) == 0x6)
+      return KernelInstructionSet::AVX2;
+    return KernelInstructionSet::SSE2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return KernelInstructionSet::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+      return KernelInstructionSet::AVX2;
+    return KernelInstructionSet::SSE2;
+#endif
+  }
+#else
+  KernelInstructionSet DetectInstructionSet()
+  {
+    return KernelInstructionSet::Scalar;
+  }
+#endif
+
+  PriceKernel SelectPriceKernel()
+  {
+    switch (GetKernelInstructionSet())
+    {
+#ifdef KERNEL_X86
+    case KernelInstructionSet::AVX512:
+      return AVX512RowPrice;
+    case KernelInstructionSet::AVX2:
+      return AVX2RowPrice;
+    case KernelInstructionSet::SSE2:
+      return SSE2RowPrice;
+#endif
+    default:
+      return ScalarRowPrice;
+    }
+  }
+
+  DotKernel SelectDotKernel()
+  {
+    switch (GetKernelInstructionSet())
+    {
+#ifdef KERNEL_X86
+    case KernelInstructionSet::AVX512:
+      return AVX512DotProduct;
+    case KernelInstructionSet::AVX2:
+      return AVX2DotProduct;
+    case KernelInstructionSet::SSE2:
+      return SSE2DotProduct;
+#endif
+    default:
+      return ScalarDotProduct;
+    }
+  }
+
+  ScaledRowKernel SelectScaledRowKernel()
+  {
+    switch (GetKernelInstructionSet())
+    {
+#ifdef KERNEL_X86
+    case KernelInstructionSet::AVX512:
+      return AVX512AddScaledRow;
+    case KernelInstructionSet::AVX2:
+      return AVX2AddScaledRow;
+    case KernelInstructionSet::SSE2:
+      return SSE2AddScaledRow;
+#endif
+    default:
+      return ScalarAddScaledRow;
+    }
+  }
+
+  RowKernel SelectRowKernel()
+  {
+    switch (GetKernelInstructionSet())
+    {
+#ifdef KERNEL_X86
+    case KernelInstructionSet::AVX512:
+      return AVX512RowMinimum;
+    case KernelInstructionSet::AVX2:
+      return AVX2RowMinimum;
+    case KernelInstructionSet::SSE2:
+      return SSE2RowMinimum;
+#endif
+    default:
+      return ScalarRowMinimum;
+    }
+  }
+}
+
+namespace TransportTask
+{
+  ReducedCostMinimum FindRowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                    double i_row_potential, const double* i_column_potentials, SizeType i_columns_count)
+  {
+    static const RowKernel kernel = SelectRowKernel();
+    return kernel(i_costs, i_basis_mask, i_row_potential, i_column_potentials, i_columns_count);
+  }
+
+  double RowTransportPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count)
+  {
+    static const PriceKernel kernel = SelectPriceKernel();
+    return kernel(i_flows, i_costs, i_columns_count);
+  }
+
+  double RowDotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count)
+  {
+    static const DotKernel kernel = SelectDotKernel();
+    return kernel(i_lhs, i_rhs, i_count);
+  }
+
+  void AddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count)
+  {
+    static const ScaledRowKernel kernel = SelectScaledRowKernel();
+    kernel(io_sums, i_row, i_scale, i_count);
+  }
+
+  KernelInstructionSet GetKernelInstructionSet()
+  {
+    static const KernelInstructionSet instruction_set = DetectInstructionSet();
+    return instruction_set;
+  }
+}
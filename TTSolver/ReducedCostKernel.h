@@ -0,0 +1,37 @@
+#pragma once
+#include "Utility.h"
+#include <cstdint>
+
+namespace TransportTask
+{
+  struct ReducedCostMinimum
+  {
+    double reduced_cost = std::numeric_limits<double>::infinity();
+    SizeType column = std::numeric_limits<SizeType>::max();
+  };
+
+  // Basis mask of a cell : non-basic cells are at their lower bound without flow or at their upper bound with the capacity
+  constexpr std::uint8_t lower_bound_mask = 0;
+  constexpr std::uint8_t basic_mask = 1;
+  constexpr std::uint8_t upper_bound_mask = 2;
+
+  // Minimal c[j] - u - v[j] over the cells of a row at the lower bound and u + v[j] - c[j] over the ones at the upper bound,
+  // so negative values improve the basis in both cases. Basic cells are skipped, ties are resolved to the lowest column.
+  // Uses AVX-512, AVX2 or SSE2 implementation depending on the processor, the results are identical to the scalar one
+  ReducedCostMinimum FindRowMinimum(const double* i_costs, const std::uint8_t* i_basis_mask,
+                                    double i_row_potential, const double* i_column_potentials, SizeType i_columns_count);
+
+  // Sum of flow[j] * c[j] over the cells of a row whose flow isn't empty_value, partial sums are kept in 8 lanes
+  // by every implementation, so all of them return the same value
+  double RowTransportPrice(const double* i_flows, const double* i_costs, SizeType i_columns_count);
+
+  // Sum of lhs[j] * rhs[j], partial sums are kept in 8 lanes by every implementation like in RowTransportPrice
+  double RowDotProduct(const double* i_lhs, const double* i_rhs, SizeType i_count);
+
+  // io_sums[j] += i_scale * i_row[j] without fused multiply-add, so every implementation gives the same sums
+  void AddScaledRow(double* io_sums, const double* i_row, double i_scale, SizeType i_count);
+
+  enum class KernelInstructionSet { Scalar, SSE2, AVX2, AVX512 };
+
+  KernelInstructionSet GetKernelInstructionSet();
+}
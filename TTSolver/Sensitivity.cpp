@@ -0,0 +1,196 @@
+#include "pch.h"
+#include "Sensitivity.h"
+#include "BasisTree.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+
+  struct NonBasicCell
+  {
+    double reduced_cost;
+    std::uint32_t row;
+    std::uint32_t column;
+  };
+
+  void CheckSolution(const TransportInformation& i_data, const SolutionInfo& i_solution)
+  {
+    if (i_solution.final_basis.GetRowsCount() != i_data.m_resources.size()
+        || i_solution.final_basis.GetColumnsCount() != i_data.m_requirements.size())
+      throw std::runtime_error{ "Solution doesn't belong to the task !" };
+    if (i_data.IsCapacitated())
+      throw std::runtime_error{ "Sensitivity of capacitated tasks isn't supported !" };
+  }
+
+  // Binary lifting over the parents of the basis tree, the root is its own parent
+  class AncestorTable
+  {
+  public:
+    AncestorTable(const BasisTree& i_tree, SizeType i_nodes_count)
+      :m_tree{ i_tree }
+    {
+      m_levels.emplace_back(i_nodes_count);
+      for (SizeType node = 0; node < i_nodes_count; ++node)
+      {
+        const SizeType parent = i_tree.GetParent(node);
+        m_levels[0][node] = parent == BasisTree::npos ? node : parent;
+      }
+      while ((SizeType{ 1 } << m_levels.size()) < i_nodes_count)
+      {
+        const auto& previous = m_levels.back();
+        Vector<SizeType> level(i_nodes_count);
+        for (SizeType node = 0; node < i_nodes_count; ++node)
+          level[node] = previous[previous[node]];
+        m_levels.push_back(std::move(level));
+      }
+    }
+
+    SizeType FindJoin(SizeType i_first, SizeType i_second) const
+    {
+      if (m_tree.GetDepth(i_first) < m_tree.GetDepth(i_second))
+        std::swap(i_first, i_second);
+      const SizeType depth_difference = m_tree.GetDepth(i_first) - m_tree.GetDepth(i_second);
+      for (SizeType level = 0; level < m_levels.size(); ++level)
+      {
+        if ((depth_difference >> level) & 1)
+          i_first = m_levels[level][i_first];
+      }
+      if (i_first == i_second)
+        return i_first;
+      for (SizeType level = m_levels.size(); level-- > 0;)
+      {
+        if (m_levels[level][i_first] != m_levels[level][i_second])
+        {
+          i_first = m_levels[level][i_first];
+          i_second = m_levels[level][i_second];
+        }
+      }
+      return m_levels[0][i_first];
+    }
+  private:
+    const BasisTree& m_tree;
+    Vector<Vector<SizeType>> m_levels;
+  };
+
+  // Deepest node not bounded yet among the node and its ancestors of the same parity, links are halved on the way
+  SizeType FindUnbounded(Vector<SizeType>& io_next, SizeType i_node)
+  {
+    while (io_next[i_node] != i_node)
+    {
+      io_next[i_node] = io_next[io_next[i_node]];
+      i_node = io_next[i_node];
+    }
+    return i_node;
+  }
+}
+
+namespace TransportTask
+{
+  SensitivityReport ComputeSensitivity(const TransportInformation& i_data, const SolutionInfo& i_solution)
+  {
+    CheckSolution(i_data, i_solution);
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    const SizeType rows_count = costs_matrix.GetRowsCount();
+    const SizeType columns_count = costs_matrix.GetColumnsCount();
+    const SizeType nodes_count = rows_count + columns_count;
+    SolverWorkspace workspace;
+    BasisTree basis(i_solution.final_basis, costs_matrix, workspace);
+    const auto& potentials = basis.GetPotentials();
+
+    SensitivityReport report;
+    report.reduced_costs = Matrix<double>(rows_count, columns_count, 0.0);
+    report.cost_ranges = Matrix<ValueRange>(rows_count, columns_count);
+    report.resources_shadow_prices = potentials.m_rows;
+    report.requirements_shadow_prices = potentials.m_columns;
+    Vector<NonBasicCell> non_basic_cells;
+    non_basic_cells.reserve(rows_count * columns_count - (nodes_count - 1));
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (basis.IsBasic(i, j))
+          continue;
+        const double reduced_cost = costs_matrix[i][j] - potentials.PotentialAt(i, j);
+        if (reduced_cost < -potentials_tolerance)
+          throw std::runtime_error{ "Solution isn't optimal for the given costs !" };
+        report.reduced_costs[i][j] = std::max(reduced_cost, 0.0);
+        report.cost_ranges[i][j] = { costs_matrix[i][j] - report.reduced_costs[i][j], infinity };
+        non_basic_cells.push_back({ report.reduced_costs[i][j], static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j) });
+      }
+    }
+    std::sort(non_basic_cells.begin(), non_basic_cells.end(),
+      [](const NonBasicCell& lhs, const NonBasicCell& rhs) { return lhs.reduced_cost < rhs.reduced_cost; });
+
+    // Changing the cost of the basic cell of node c by delta shifts potentials of the subtree of c, rows and columns in
+    // opposite directions, so only the reduced costs of cells whose cycle passes c change. A cell bounds the increase of
+    // c when c and the end of the cell inside the subtree are both rows or both columns, and the decrease otherwise,
+    // i.e. the increase is bounded by nodes at even distance from the end of the cell and the decrease by the odd ones.
+    // The cheapest cell passing a node gives its bound, so bounded nodes are skipped by jumping to their grandparents
+    const SizeType no_node = nodes_count;
+    Vector<double> increase_bounds(nodes_count, infinity);
+    Vector<double> decrease_bounds(nodes_count, infinity);
+    Vector<SizeType> next_for_increase(nodes_count + 1);
+    for (SizeType node = 0; node <= nodes_count; ++node)
+      next_for_increase[node] = node;
+    Vector<SizeType> next_for_decrease(next_for_increase);
+    const AncestorTable ancestors(basis, nodes_count);
+    const SizeType bounds_count = 2 * (nodes_count - 1);
+    SizeType bounded_count = 0;
+    auto bound_path = [&](Vector<SizeType>& io_next, Vector<double>& io_bounds, SizeType i_start, SizeType i_join_depth, double i_bound)
+    {
+      if (i_start == BasisTree::npos)
+        return;
+      for (SizeType node = FindUnbounded(io_next, i_start); node != no_node && basis.GetDepth(node) > i_join_depth;
+           node = FindUnbounded(io_next, node))
+      {
+        io_bounds[node] = i_bound;
+        const SizeType grandparent = basis.GetParent(basis.GetParent(node));
+        io_next[node] = grandparent == BasisTree::npos ? no_node : grandparent;
+        ++bounded_count;
+      }
+    };
+    for (const auto& cell : non_basic_cells)
+    {
+      if (bounded_count == bounds_count)
+        break;
+      const SizeType row_node = cell.row;
+      const SizeType column_node = rows_count + cell.column;
+      const SizeType join_depth = basis.GetDepth(ancestors.FindJoin(row_node, column_node));
+      for (SizeType end : { row_node, column_node })
+      {
+        bound_path(next_for_increase, increase_bounds, end, join_depth, cell.reduced_cost);
+        bound_path(next_for_decrease, decrease_bounds, basis.GetParent(end), join_depth, cell.reduced_cost);
+      }
+    }
+    for (SizeType node = 1; node < nodes_count; ++node)
+    {
+      auto [row, column] = basis.GetParentCell(node);
+      report.cost_ranges[row][column] = { costs_matrix[row][column] - decrease_bounds[node], costs_matrix[row][column] + increase_bounds[node] };
+    }
+    return report;
+  }
+
+  ValueRange GetQuantityRange(const TransportInformation& i_data, const SolutionInfo& i_solution, SizeType i_row, SizeType i_column)
+  {
+    CheckSolution(i_data, i_solution);
+    SolverWorkspace workspace;
+    BasisTree basis(i_solution.final_basis, i_data.m_costs_matrix, workspace);
+    // Added amount goes along the tree path from the row to the column, opposite to the flow pushed through the entering cell
+    ValueRange range{ -infinity, infinity };
+    for (const auto& element : basis.FindCycle({ i_row, i_column }))
+    {
+      if (element.node == BasisTree::npos)
+        continue;
+      if (element.is_increased)
+        range.upper = std::min(range.upper, basis.GetFlow(element.node));
+      else
+        range.lower = std::max(range.lower, -basis.GetFlow(element.node));
+    }
+    return range;
+  }
+}
\ No newline at end of file
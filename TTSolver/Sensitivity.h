@@ -0,0 +1,34 @@
+#pragma once
+#include "Utility.h"
+#include "ExportHeader.h"
+
+namespace TransportTask
+{
+  // Infinite bounds mean that the value isn't limited in that direction
+  struct ValueRange
+  {
+    double lower = 0.0;
+    double upper = 0.0;
+  };
+
+  struct SensitivityReport
+  {
+    // Zero for basic cells, a non-basic cell enters the basis once its cost drops by its reduced cost
+    Matrix<double> reduced_costs;
+    // Costs of a cell keeping the final basis optimal while the other costs are fixed
+    Matrix<ValueRange> cost_ranges;
+    // Potentials of the final basis with zero potential of the first row, a unit added to resource i and requirement j
+    // changes the objective by resources_shadow_prices[i] + requirements_shadow_prices[j]
+    Vector<double> resources_shadow_prices;
+    Vector<double> requirements_shadow_prices;
+  };
+
+  // Ranges of basic cells are found for all cells at once : non-basic cells are taken by reduced cost and bound
+  // the tree cells of their cycles which aren't bounded yet, so the whole report costs O(m * n * log(m * n)).
+  // Tasks with capacities aren't supported
+  SOLVER_API SensitivityReport ComputeSensitivity(const TransportInformation& i_data, const SolutionInfo& i_solution);
+
+  // Amounts which may be added to both resource i_row and requirement i_column while the final basis stays feasible,
+  // shadow prices of the report are valid inside this range
+  SOLVER_API ValueRange GetQuantityRange(const TransportInformation& i_data, const SolutionInfo& i_solution, SizeType i_row, SizeType i_column);
+}
\ No newline at end of file
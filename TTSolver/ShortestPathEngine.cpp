@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "ShortestPathEngine.h"
+#include <algorithm>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  constexpr SizeType no_node = std::numeric_limits<SizeType>::max();
+
+  struct HeapEntry
+  {
+    double distance;
+    SizeType node;
+  };
+
+  bool IsFarther(const HeapEntry& lhs, const HeapEntry& rhs)
+  {
+    return lhs.distance > rhs.distance;
+  }
+}
+
+namespace TransportTask
+{
+  Matrix<double> SolveByShortestPaths(const TransportInformation& i_data)
+  {
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    const SizeType rows_count = costs_matrix.GetRowsCount();
+    const SizeType columns_count = costs_matrix.GetColumnsCount();
+    const SizeType nodes_count = rows_count + columns_count;
+    auto resources = i_data.m_resources;
+    auto requirements = i_data.m_requirements;
+    Matrix<double> flows(rows_count, columns_count, 0.0);
+
+    // Reduced cost of the arc from u to v is cost + potential[u] - potential[v], arcs go from rows to columns
+    // and back along the cells with flow. Cheapest cells of the columns make all arcs non-negative at start,
+    // their reduced costs are zero, so columns are filled from them before the first search
+    Vector<double> potentials(nodes_count, 0.0);
+    for (SizeType j = 0; j < columns_count; ++j)
+    {
+      const auto column = costs_matrix.Column(j);
+      SizeType cheapest_row = 0;
+      for (SizeType i = 1; i < rows_count; ++i)
+      {
+        if (column[i] < column[cheapest_row])
+          cheapest_row = i;
+      }
+      potentials[rows_count + j] = column[cheapest_row];
+      const double amount = std::min(requirements[j], resources[cheapest_row]);
+      flows[cheapest_row][j] += amount;
+      requirements[j] -= amount;
+      resources[cheapest_row] -= amount;
+    }
+
+    Vector<double> distances(nodes_count);
+    Vector<SizeType> predecessors(nodes_count);
+    Vector<std::uint8_t> settled(nodes_count);
+    Vector<HeapEntry> heap;
+    for (;;)
+    {
+      std::fill(distances.begin(), distances.end(), infinity);
+      std::fill(settled.begin(), settled.end(), 0);
+      heap.clear();
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        if (resources[i] > 0.0)
+        {
+          distances[i] = 0.0;
+          predecessors[i] = no_node;
+          heap.push_back({ 0.0, i });
+        }
+      }
+      auto relax = [&](SizeType i_from, SizeType i_to, double i_reduced_cost)
+      {
+        const double distance = distances[i_from] + std::max(i_reduced_cost, 0.0);
+        if (!settled[i_to] && distance < distances[i_to])
+        {
+          distances[i_to] = distance;
+          predecessors[i_to] = i_from;
+          heap.push_back({ distance, i_to });
+          std::push_heap(heap.begin(), heap.end(), IsFarther);
+        }
+      };
+
+      // Search stops at the first column with requirements left
+      SizeType target = no_node;
+      while (!heap.empty())
+      {
+        std::pop_heap(heap.begin(), heap.end(), IsFarther);
+        const SizeType node = heap.back().node;
+        heap.pop_back();
+        if (settled[node])
+          continue;
+        settled[node] = 1;
+        if (node < rows_count)
+        {
+          const auto row_costs = costs_matrix[node];
+          for (SizeType j = 0; j < columns_count; ++j)
+            relax(node, rows_count + j, row_costs[j] + potentials[node] - potentials[rows_count + j]);
+        }
+        else
+        {
+          const SizeType column = node - rows_count;
+          if (requirements[column] > 0.0)
+          {
+            target = node;
+            break;
+          }
+          const auto column_flows = flows.Column(column);
+          const auto column_costs = costs_matrix.Column(column);
+          for (SizeType i = 0; i < rows_count; ++i)
+          {
+            if (column_flows[i] > 0.0)
+              relax(node, i, potentials[node] - potentials[i] - column_costs[i]);
+          }
+        }
+      }
+      if (target == no_node)
+        break;
+
+      // Nodes beyond the target are shifted by its distance, so reduced costs stay non-negative
+      const double target_distance = distances[target];
+      for (SizeType node = 0; node < nodes_count; ++node)
+        potentials[node] += std::min(distances[node], target_distance);
+
+      double amount = requirements[target - rows_count];
+      SizeType source = target;
+      for (SizeType node = target; node != no_node; node = predecessors[node])
+      {
+        const SizeType predecessor = predecessors[node];
+        if (predecessor == no_node)
+          source = node;
+        else if (node < rows_count)
+          amount = std::min(amount, flows[node][predecessor - rows_count]);
+      }
+      amount = std::min(amount, resources[source]);
+      for (SizeType node = target; predecessors[node] != no_node; node = predecessors[node])
+      {
+        const SizeType predecessor = predecessors[node];
+        if (node < rows_count)
+          flows[node][predecessor - rows_count] -= amount;
+        else
+          flows[predecessor][node - rows_count] += amount;
+      }
+      resources[source] -= amount;
+      requirements[target - rows_count] -= amount;
+    }
+
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (auto& flow : flows[i])
+      {
+        if (flow <= 0.0)
+          flow = empty_value;
+      }
+    }
+    return flows;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+#include "Utility.h"
+
+namespace TransportTask
+{
+  // Bipartite min-cost flow : every augmentation sends flow from the rows with resources left to the nearest column
+  // with requirements left, distances are found by Dijkstra over reduced costs with a binary heap.
+  // Returns the optimal plan, cells without flow keep empty_value
+  Matrix<double> SolveByShortestPaths(const TransportInformation& i_data);
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "pch.h"
+#include "SinkhornEngine.h"
+#include "BasisTree.h"
+#include "ReducedCostKernel.h"
+#include "TableCreator.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr double annealing_factor = 0.5;
+  // Scalings beyond exp(absorption_threshold) are moved into the potentials before they overflow
+  constexpr double absorption_threshold = 200.0;
+  constexpr double minimal_column_mass = 1e-300;
+
+  class SinkhornScaling
+  {
+  public:
+    SinkhornScaling(const TransportInformation& i_data, ThreadPool* i_thread_pool)
+      :m_costs{ i_data.m_costs_matrix }
+      ,m_resources{ i_data.m_resources }
+      ,m_requirements{ i_data.m_requirements }
+      ,m_thread_pool{ i_thread_pool }
+      ,m_kernel(m_resources.size(), m_requirements.size())
+      ,m_row_potentials(m_resources.size(), 0.0)
+      ,m_column_potentials(m_requirements.size(), 0.0)
+      ,m_row_scalings(m_resources.size(), 1.0)
+      ,m_column_scalings(m_requirements.size(), 1.0)
+      ,m_column_masses(m_requirements.size())
+    {}
+
+    SinkhornResult Solve(const SinkhornSettings& i_settings)
+    {
+      const SizeType rows_count = m_resources.size();
+      double max_cost = 0.0;
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        for (double cost : m_costs[i])
+          max_cost = std::max(max_cost, std::abs(cost));
+      }
+      double total_requirements = 0.0;
+      for (double requirement : m_requirements)
+        total_requirements += requirement;
+      const double final_epsilon = std::max(max_cost, 1.0) * i_settings.regularization;
+      const double allowed_error = i_settings.tolerance * total_requirements;
+
+      SinkhornResult result;
+      for (double epsilon = std::max(max_cost, final_epsilon);; epsilon = std::max(epsilon * annealing_factor, final_epsilon))
+      {
+        m_epsilon = epsilon;
+        BuildKernel();
+        while (result.iterations_count < i_settings.max_iterations)
+        {
+          ++result.iterations_count;
+          if (ScaleRowsAndColumns() <= allowed_error)
+            break;
+          if (IsScalingLarge())
+          {
+            AbsorbScalings();
+            BuildKernel();
+          }
+        }
+        AbsorbScalings();
+        if (epsilon == final_epsilon || result.iterations_count >= i_settings.max_iterations)
+          break;
+      }
+
+      BuildKernel();
+      result.plan = std::move(m_kernel);
+      for (SizeType i = 0; i < rows_count; ++i)
+        result.objective += RowTransportPrice(result.plan[i].data(), m_costs[i].data(), m_requirements.size());
+      result.lower_bound = CalculateLowerBound();
+      return result;
+    }
+  private:
+    void BuildKernel()
+    {
+      const SizeType columns_count = m_requirements.size();
+      RunInRanges(m_thread_pool, m_resources.size(), columns_count, [this, columns_count](SizeType, SizeType i_first, SizeType i_last)
+      {
+        for (SizeType i = i_first; i < i_last; ++i)
+        {
+          const auto costs_row = m_costs[i];
+          const auto kernel_row = m_kernel[i];
+          // Lines without quantity get no mass at all, their potentials are meaningless
+          for (SizeType j = 0; j < columns_count; ++j)
+          {
+            kernel_row[j] = m_resources[i] == 0.0 || m_requirements[j] == 0.0 ? 0.0
+              : std::exp((m_row_potentials[i] + m_column_potentials[j] - costs_row[j]) / m_epsilon);
+          }
+        }
+      });
+      std::fill(m_row_scalings.begin(), m_row_scalings.end(), 1.0);
+      std::fill(m_column_scalings.begin(), m_column_scalings.end(), 1.0);
+    }
+
+    // Rows are matched exactly, the returned error of the requirements is measured before the columns are rescaled
+    double ScaleRowsAndColumns()
+    {
+      const SizeType rows_count = m_resources.size();
+      const SizeType columns_count = m_requirements.size();
+      RunInRanges(m_thread_pool, rows_count, columns_count, [this, columns_count](SizeType, SizeType i_first, SizeType i_last)
+      {
+        for (SizeType i = i_first; i < i_last; ++i)
+        {
+          const double mass = RowDotProduct(m_kernel[i].data(), m_column_scalings.data(), columns_count);
+          m_row_scalings[i] = m_resources[i] == 0.0 || mass == 0.0 ? 0.0 : m_resources[i] / mass;
+        }
+      });
+      // Columns are split instead of rows, so every column sums the rows in the same order
+      RunInRanges(m_thread_pool, columns_count, rows_count, [this, rows_count](SizeType, SizeType i_first, SizeType i_last)
+      {
+        std::fill(m_column_masses.begin() + i_first, m_column_masses.begin() + i_last, 0.0);
+        for (SizeType i = 0; i < rows_count; ++i)
+        {
+          if (m_row_scalings[i] != 0.0)
+            AddScaledRow(m_column_masses.data() + i_first, m_kernel[i].data() + i_first, m_row_scalings[i], i_last - i_first);
+        }
+      });
+      double error = 0.0;
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        error += std::abs(m_column_scalings[j] * m_column_masses[j] - m_requirements[j]);
+        m_column_scalings[j] = m_requirements[j] == 0.0 ? 0.0 : m_requirements[j] / std::max(m_column_masses[j], minimal_column_mass);
+      }
+      return error;
+    }
+
+    bool IsScalingLarge() const
+    {
+      auto is_large = [](double i_scaling) { return i_scaling != 0.0 && std::abs(std::log(i_scaling)) > absorption_threshold; };
+      return std::any_of(m_row_scalings.cbegin(), m_row_scalings.cend(), is_large)
+        || std::any_of(m_column_scalings.cbegin(), m_column_scalings.cend(), is_large);
+    }
+
+    // Lines without quantity keep zero scaling, so their potentials aren't touched
+    void AbsorbScalings()
+    {
+      for (SizeType i = 0; i < m_row_potentials.size(); ++i)
+      {
+        if (m_row_scalings[i] != 0.0)
+          m_row_potentials[i] += m_epsilon * std::log(m_row_scalings[i]);
+      }
+      for (SizeType j = 0; j < m_column_potentials.size(); ++j)
+      {
+        if (m_column_scalings[j] != 0.0)
+          m_column_potentials[j] += m_epsilon * std::log(m_column_scalings[j]);
+      }
+    }
+
+    // Column potentials are replaced by the smallest c[i][j] - f[i], so every cell satisfies f[i] + g[j] <= c[i][j],
+    // then row potentials are raised to the smallest c[i][j] - g[j] in the same way
+    double CalculateLowerBound() const
+    {
+      const SizeType rows_count = m_resources.size();
+      const SizeType columns_count = m_requirements.size();
+      Vector<double> feasible_columns(columns_count, std::numeric_limits<double>::infinity());
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        if (m_resources[i] == 0.0)
+          continue;
+        const auto costs_row = m_costs[i];
+        for (SizeType j = 0; j < columns_count; ++j)
+          feasible_columns[j] = std::min(feasible_columns[j], costs_row[j] - m_row_potentials[i]);
+      }
+      double bound = 0.0;
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (m_requirements[j] != 0.0)
+          bound += m_requirements[j] * feasible_columns[j];
+      }
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        if (m_resources[i] == 0.0)
+          continue;
+        const auto costs_row = m_costs[i];
+        double feasible_row = std::numeric_limits<double>::infinity();
+        for (SizeType j = 0; j < columns_count; ++j)
+        {
+          if (m_requirements[j] != 0.0)
+            feasible_row = std::min(feasible_row, costs_row[j] - feasible_columns[j]);
+        }
+        bound += m_resources[i] * feasible_row;
+      }
+      return bound;
+    }
+
+    const Matrix<double>& m_costs;
+    const Vector<double>& m_resources;
+    const Vector<double>& m_requirements;
+    ThreadPool* m_thread_pool;
+    double m_epsilon = 1.0;
+    Matrix<double> m_kernel;
+    Vector<double> m_row_potentials;
+    Vector<double> m_column_potentials;
+    Vector<double> m_row_scalings;
+    Vector<double> m_column_scalings;
+    Vector<double> m_column_masses;
+  };
+
+  struct RoundingCell
+  {
+    double value;
+    double limit;
+    SizeType row;
+    SizeType column;
+  };
+
+  void FillGreedily(Matrix<double>& io_plan, Vector<double>& io_resources, Vector<double>& io_requirements, const Vector<RoundingCell>& i_cells)
+  {
+    for (const auto& cell : i_cells)
+    {
+      const double amount = std::min({ cell.limit, io_resources[cell.row], io_requirements[cell.column] });
+      if (amount <= 0.0)
+        continue;
+      io_plan[cell.row][cell.column] = io_plan[cell.row][cell.column] == empty_value ? amount : io_plan[cell.row][cell.column] + amount;
+      io_resources[cell.row] -= amount;
+      io_requirements[cell.column] -= amount;
+    }
+  }
+
+  bool HasIntegralQuantities(const TransportInformation& i_data)
+  {
+    auto is_integral = [](double i_quantity) { return i_quantity == std::floor(i_quantity); };
+    return std::all_of(i_data.m_resources.cbegin(), i_data.m_resources.cend(), is_integral)
+      && std::all_of(i_data.m_requirements.cbegin(), i_data.m_requirements.cend(), is_integral);
+  }
+}
+
+namespace TransportTask
+{
+  SinkhornResult SolveBySinkhorn(const TransportInformation& i_data, const SinkhornSettings& i_settings, ThreadPool* i_thread_pool)
+  {
+    SinkhornScaling scaling(i_data, i_thread_pool);
+    return scaling.Solve(i_settings);
+  }
+
+  Matrix<double> RoundPlan(const TransportInformation& i_data, const Matrix<double>& i_plan)
+  {
+    const SizeType rows_count = i_data.m_resources.size();
+    const SizeType columns_count = i_data.m_requirements.size();
+    auto resources = i_data.m_resources;
+    auto requirements = i_data.m_requirements;
+    Matrix<double> rounded_plan(rows_count, columns_count, empty_value);
+    auto is_bigger = [](const RoundingCell& lhs, const RoundingCell& rhs)
+    {
+      return lhs.value > rhs.value || (lhs.value == rhs.value && std::make_pair(lhs.row, lhs.column) < std::make_pair(rhs.row, rhs.column));
+    };
+
+    const bool is_integral = HasIntegralQuantities(i_data);
+    Vector<RoundingCell> cells;
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        const double limit = i_plan[i][j] == empty_value ? 0.0 : is_integral ? std::floor(i_plan[i][j]) : i_plan[i][j];
+        if (limit > 0.0)
+          cells.push_back({ i_plan[i][j], limit, i, j });
+      }
+    }
+    std::sort(cells.begin(), cells.end(), is_bigger);
+    FillGreedily(rounded_plan, resources, requirements, cells);
+
+    // Parts cut by the rounding go to the cells with the biggest remainders of the plan, every filling closes a line
+    cells.clear();
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      if (resources[i] <= 0.0)
+        continue;
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (requirements[j] <= 0.0)
+          continue;
+        const double value = i_plan[i][j] == empty_value ? 0.0 : i_plan[i][j];
+        const double filled = rounded_plan[i][j] == empty_value ? 0.0 : rounded_plan[i][j];
+        cells.push_back({ value - filled, resources[i], i, j });
+      }
+    }
+    std::sort(cells.begin(), cells.end(), is_bigger);
+    FillGreedily(rounded_plan, resources, requirements, cells);
+    return rounded_plan;
+  }
+
+  SolutionInfo GetApproximateSolution(const TransportInformation& i_data, const SinkhornSettings& i_settings, ThreadPool* i_thread_pool)
+  {
+    const auto sinkhorn_result = SolveBySinkhorn(i_data, i_settings, i_thread_pool);
+    SolutionInfo solution_details;
+    solution_details.final_basis = FormatTaskFromApproximatePlan(i_data, RoundPlan(i_data, sinkhorn_result.plan), solution_details.saturated_cells);
+    SolverWorkspace workspace;
+    BasisTree basis(solution_details.final_basis, solution_details.saturated_cells, i_data.m_costs_matrix, i_data.m_capacities, workspace);
+    solution_details.final_potentials = basis.GetPotentials();
+    solution_details.objective = basis.CalculateObjective();
+    solution_details.optimality_gap = std::max(solution_details.objective - sinkhorn_result.lower_bound, 0.0);
+    solution_details.iterations_count = 1;
+    return solution_details;
+  }
+}
\ No newline at end of file
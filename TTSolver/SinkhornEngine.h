@@ -0,0 +1,43 @@
+#pragma once
+#include "Utility.h"
+#include "ExportHeader.h"
+
+class ThreadPool;
+
+namespace TransportTask
+{
+  struct SinkhornSettings
+  {
+    // Final entropic regularization relative to the biggest absolute cost, smaller values give plans closer to the optimal one
+    double regularization = 1e-3;
+    // Stage of annealing stops once the requirements are matched up to this share of the total amount
+    double tolerance = 1e-6;
+    SizeType max_iterations = 10000;
+  };
+
+  struct SinkhornResult
+  {
+    // Entropic plan, it matches the resources and the requirements up to the tolerance
+    Matrix<double> plan;
+    double objective = 0.0;
+    // Dual objective of the final scaling potentials made feasible, the optimal objective isn't below it
+    double lower_bound = 0.0;
+    SizeType iterations_count = 0;
+  };
+
+  // Sinkhorn-Knopp scaling of the kernel exp((f[i] + g[j] - c[i][j]) / epsilon) : large scalings are absorbed into the
+  // potentials f and g and the kernel is rebuilt, epsilon is halved from the biggest cost down to the regularization.
+  // Matrix-vector products use the vectorized kernels, rows are split between the threads of the pool if it is given
+  SOLVER_API SinkhornResult SolveBySinkhorn(const TransportInformation& i_data, const SinkhornSettings& i_settings = {},
+                                            ThreadPool* i_thread_pool = nullptr);
+
+  // Feasible plan close to the given one : cells are filled in decreasing order up to their values, rounded down when
+  // all quantities are integral, and the rest goes to the cells with the biggest remainders. Integral quantities give
+  // integral flows, the plan may contain cycles which FormatTaskFromPlan cancels
+  SOLVER_API Matrix<double> RoundPlan(const TransportInformation& i_data, const Matrix<double>& i_plan);
+
+  // Rounded Sinkhorn plan completed to basis without simplex iterations, optimality_gap of the result is the distance
+  // between its objective and the lower bound of Sinkhorn
+  SOLVER_API SolutionInfo GetApproximateSolution(const TransportInformation& i_data, const SinkhornSettings& i_settings = {},
+                                                 ThreadPool* i_thread_pool = nullptr);
+}
\ No newline at end of file
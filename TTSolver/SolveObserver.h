@@ -0,0 +1,28 @@
+#pragma once
+#include "Utility.h"
+#include <chrono>
+
+namespace TransportTask
+{
+  struct IterationProgress
+  {
+    SizeType iteration;
+    double objective;
+    PairOf<SizeType> entering;
+    SizeType cycle_length;
+    std::chrono::duration<double> elapsed;
+  };
+
+  // Hooks are called on the thread running the solve, an exception thrown from a hook aborts the solve
+  class SolveObserver
+  {
+  public:
+    virtual ~SolveObserver() = default;
+
+    virtual void OnInitialBasis(const Matrix<double>&, double) {}
+
+    virtual void OnIteration(const IterationProgress&) {}
+
+    virtual void OnFinished(const SolutionInfo&) {}
+  };
+}
@@ -0,0 +1,34 @@
+#include "pch.h"
+#include "SolverWorkspace.h"
+
+namespace TransportTask
+{
+  SolverWorkspace::SolverWorkspace(SizeType i_rows_count, SizeType i_columns_count)
+  {
+    Prepare(i_rows_count, i_columns_count);
+  }
+
+  void SolverWorkspace::Prepare(SizeType i_rows_count, SizeType i_columns_count)
+  {
+    const SizeType nodes_count = i_rows_count + i_columns_count;
+    const SizeType half_edges_count = 2 * (nodes_count - 1);
+    const SizeType npos = std::numeric_limits<SizeType>::max();
+    m_parent.assign(nodes_count, npos);
+    m_depth.assign(nodes_count, 0);
+    m_thread.assign(nodes_count, npos);
+    m_reverse_thread.assign(nodes_count, npos);
+    m_flow.assign(nodes_count, 0.0);
+    m_first_half_edge.assign(nodes_count, npos);
+    m_next_half_edge.assign(half_edges_count, npos);
+    m_previous_half_edge.assign(half_edges_count, npos);
+    m_half_edge_target.assign(half_edges_count, npos);
+    m_basis_mask.assign(i_rows_count * i_columns_count, 0);
+    m_potentials.m_rows.assign(i_rows_count, empty_value);
+    m_potentials.m_columns.assign(i_columns_count, empty_value);
+    m_checked_potentials.m_rows.assign(i_rows_count, empty_value);
+    m_checked_potentials.m_columns.assign(i_columns_count, empty_value);
+    m_nodes_stack.reserve(nodes_count);
+    m_visited.assign(nodes_count, 0);
+    m_cycle.reserve(nodes_count);
+  }
+}
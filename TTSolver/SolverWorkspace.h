@@ -0,0 +1,44 @@
+#pragma once
+#include "Utility.h"
+#include "ExportHeader.h"
+#include <cstdint>
+
+namespace TransportTask
+{
+  struct BasisCycleElement
+  {
+    SizeType node;
+    PairOf<SizeType> cell;
+    bool is_increased;
+  };
+
+  // Scratch buffers of the basis tree, they are sized once per task and keep their capacity between solves,
+  // so pivots don't touch the heap. Workspace can't be shared by solves running at the same time
+  struct SolverWorkspace
+  {
+    SolverWorkspace() = default;
+
+    SOLVER_API SolverWorkspace(SizeType i_rows_count, SizeType i_columns_count);
+
+    SOLVER_API void Prepare(SizeType i_rows_count, SizeType i_columns_count);
+
+    Vector<SizeType> m_parent;
+    Vector<SizeType> m_depth;
+    Vector<SizeType> m_thread;
+    Vector<SizeType> m_reverse_thread;
+    Vector<double> m_flow;
+    // Tree edges as intrusive lists of half edges, edge k is split into halves 2k and 2k + 1
+    Vector<SizeType> m_first_half_edge;
+    Vector<SizeType> m_next_half_edge;
+    Vector<SizeType> m_previous_half_edge;
+    Vector<SizeType> m_half_edge_target;
+    // Zero for non-basic cells without flow, one for basic cells and two for non-basic cells at their capacities
+    Vector<std::uint8_t> m_basis_mask;
+    MatrixPotentials m_potentials{ 0, 0 };
+    MatrixPotentials m_checked_potentials{ 0, 0 };
+
+    Vector<SizeType> m_nodes_stack;
+    Vector<std::uint8_t> m_visited;
+    Vector<BasisCycleElement> m_cycle;
+  };
+}
@@ -0,0 +1,353 @@
+#include "pch.h"
+#include "SparseSolver.h"
+#include "DisjointSets.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+  using namespace TransportTask;
+
+  constexpr SizeType npos = std::numeric_limits<SizeType>::max();
+  constexpr double infeasibility_tolerance = 1e-9;
+  constexpr double artificial_rounding = 1e-14;
+
+  // Nodes are rows [0, m), columns [m, m + n) and the root m + n. Routes go first and keep the order of the task,
+  // artificial arc A + i goes from row i to the root and A + m + j from the root to column j, or from column j to the root
+  // when its requirement is zero. Reduced cost of the arc from x to y is cost - potential[x] + potential[y], so for
+  // a route it is cost - (u[i] + v[j]) with v[j] = -potential[m + j]
+  class SparseNetworkSimplex
+  {
+  public:
+    SparseNetworkSimplex(const SparseTransportInformation& i_data)
+      :m_data{ i_data }
+      ,m_rows_count{ i_data.m_resources.size() }
+      ,m_columns_count{ i_data.m_requirements.size() }
+      ,m_routes_count{ i_data.GetRoutesCount() }
+      ,m_root{ m_rows_count + m_columns_count }
+    {
+      const SizeType arcs_count = m_routes_count + m_rows_count + m_columns_count;
+      m_tail.reserve(arcs_count);
+      m_head.reserve(arcs_count);
+      m_cost.reserve(arcs_count);
+      double max_cost = 0.0;
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        for (SizeType k = i_data.m_row_offsets[i]; k < i_data.m_row_offsets[i + 1]; ++k)
+        {
+          m_tail.push_back(i);
+          m_head.push_back(m_rows_count + i_data.m_route_columns[k]);
+          m_cost.push_back(i_data.m_route_costs[k]);
+          max_cost = std::max(max_cost, std::abs(i_data.m_route_costs[k]));
+        }
+      }
+      // Any tree path is cheaper than one artificial arc, so they carry flow only if the routes can't
+      const double artificial_cost = (max_cost + 1.0) * static_cast<double>(m_root + 1);
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        m_tail.push_back(i);
+        m_head.push_back(m_root);
+        m_cost.push_back(artificial_cost);
+      }
+      // Arcs into a column never leave it, so a column without requirement reaches the root by its own artificial arc
+      for (SizeType j = 0; j < m_columns_count; ++j)
+      {
+        const bool is_empty = i_data.m_requirements[j] == 0.0;
+        m_tail.push_back(is_empty ? m_rows_count + j : m_root);
+        m_head.push_back(is_empty ? m_root : m_rows_count + j);
+        m_cost.push_back(artificial_cost);
+      }
+      m_flow.assign(arcs_count, 0.0);
+      m_is_basic.assign(arcs_count, 0);
+      m_tree_arcs.resize(m_root + 1);
+      m_parent.assign(m_root + 1, npos);
+      m_parent_arc.assign(m_root + 1, npos);
+      m_depth.assign(m_root + 1, 0);
+      m_potential.assign(m_root + 1, 0.0);
+      // Potentials behind artificial arcs are about their cost, so their rounding grows with it
+      m_tolerance = std::max(potentials_tolerance, artificial_cost * artificial_rounding);
+      m_block_size = std::max<SizeType>(m_root, static_cast<SizeType>(std::sqrt(static_cast<double>(arcs_count))));
+    }
+
+    SparseSolutionInfo Solve()
+    {
+      CheckLinesHaveRoutes();
+      FormatInitialTree();
+      SparseSolutionInfo solution_details;
+      solution_details.iterations_count = 1;
+      for (SizeType entering = SelectEntering(); entering != npos; entering = SelectEntering())
+      {
+        Pivot(entering);
+        ++solution_details.iterations_count;
+      }
+
+      double total_resources = 0.0, artificial_flow = 0.0;
+      for (double resource : m_data.m_resources)
+        total_resources += resource;
+      for (SizeType arc = m_routes_count; arc < m_flow.size(); ++arc)
+        artificial_flow += m_flow[arc];
+      if (artificial_flow > infeasibility_tolerance * std::max(total_resources, 1.0))
+        throw std::runtime_error{ "Allowed routes can't carry the resources !" };
+
+      solution_details.flows.assign(m_flow.cbegin(), m_flow.cbegin() + m_routes_count);
+      for (SizeType arc = 0; arc < m_routes_count; ++arc)
+        solution_details.objective += m_flow[arc] * m_cost[arc];
+      solution_details.final_potentials = MatrixPotentials(m_rows_count, m_columns_count);
+      for (SizeType i = 0; i < m_rows_count; ++i)
+        solution_details.final_potentials.m_rows[i] = m_potential[i] - m_potential[0];
+      for (SizeType j = 0; j < m_columns_count; ++j)
+        solution_details.final_potentials.m_columns[j] = m_potential[0] - m_potential[m_rows_count + j];
+      return solution_details;
+    }
+  private:
+    // Lines with quantity and without routes are reported before the solve, the rest is found by the artificial flow
+    void CheckLinesHaveRoutes() const
+    {
+      for (SizeType i = 0; i < m_rows_count; ++i)
+      {
+        if (m_data.m_resources[i] > 0.0 && m_data.m_row_offsets[i] == m_data.m_row_offsets[i + 1])
+          throw std::runtime_error{ "Allowed routes can't carry the resources !" };
+      }
+      Vector<std::uint8_t> has_routes(m_columns_count, 0);
+      for (SizeType column : m_data.m_route_columns)
+        has_routes[column] = 1;
+      for (SizeType j = 0; j < m_columns_count; ++j)
+      {
+        if (m_data.m_requirements[j] > 0.0 && has_routes[j] == 0)
+          throw std::runtime_error{ "Allowed routes can't carry the resources !" };
+      }
+    }
+
+    // Minimal cost plan over the routes, every investment closes a line, so the routes with flow form a forest and each
+    // of its trees keeps at most one line with something left. That line is linked with the root by its artificial arc
+    // carrying the rest. The tree is kept strongly feasible : every arc without flow points to the root, so the other
+    // trees are linked by the arc from their first row to the root. Only a column without requirement is alone in its
+    // tree, and its artificial arc goes to the root too
+    void FormatInitialTree()
+    {
+      auto resources = m_data.m_resources;
+      auto requirements = m_data.m_requirements;
+      Vector<SizeType> routes(m_routes_count);
+      std::iota(routes.begin(), routes.end(), SizeType{ 0 });
+      std::sort(routes.begin(), routes.end(), [this](SizeType lhs, SizeType rhs)
+      {
+        return m_cost[lhs] < m_cost[rhs] || (m_cost[lhs] == m_cost[rhs] && lhs < rhs);
+      });
+      DisjointSets components(m_root);
+      for (SizeType arc : routes)
+      {
+        const SizeType row = m_tail[arc];
+        const SizeType column = m_head[arc] - m_rows_count;
+        const double investment = std::min(resources[row], requirements[column]);
+        if (investment <= 0.0)
+          continue;
+        m_flow[arc] = investment;
+        resources[row] -= investment;
+        requirements[column] -= investment;
+        components.Unite(m_tail[arc], m_head[arc]);
+        LinkArc(arc);
+      }
+
+      Vector<SizeType> linked_node(m_root, npos);
+      for (SizeType node = 0; node < m_root; ++node)
+      {
+        const double rest = node < m_rows_count ? resources[node] : requirements[node - m_rows_count];
+        if (rest > 0.0)
+        {
+          linked_node[components.Find(node)] = node;
+          m_flow[ArtificialArc(node)] = rest;
+        }
+      }
+      // Rows come first, so a tree with any row is linked through a row
+      for (SizeType node = 0; node < m_root; ++node)
+      {
+        auto& linked = linked_node[components.Find(node)];
+        if (linked == npos)
+          linked = node;
+        if (linked == node)
+          LinkArc(ArtificialArc(node));
+      }
+      RebuildSubtree(m_root);
+    }
+
+    SizeType ArtificialArc(SizeType i_node) const
+    {
+      return m_routes_count + i_node;
+    }
+
+    void LinkArc(SizeType i_arc)
+    {
+      m_is_basic[i_arc] = 1;
+      m_tree_arcs[m_tail[i_arc]].push_back(i_arc);
+      m_tree_arcs[m_head[i_arc]].push_back(i_arc);
+    }
+
+    void UnlinkArc(SizeType i_arc)
+    {
+      m_is_basic[i_arc] = 0;
+      for (SizeType node : { m_tail[i_arc], m_head[i_arc] })
+      {
+        auto& arcs = m_tree_arcs[node];
+        *std::find(arcs.begin(), arcs.end(), i_arc) = arcs.back();
+        arcs.pop_back();
+      }
+    }
+
+    double ReducedCost(SizeType i_arc) const
+    {
+      return m_cost[i_arc] - m_potential[m_tail[i_arc]] + m_potential[m_head[i_arc]];
+    }
+
+    // Parents, depths and potentials of the subtree hanging from i_top, whose own ones are already set
+    void RebuildSubtree(SizeType i_top)
+    {
+      m_nodes_stack.assign(1, i_top);
+      while (!m_nodes_stack.empty())
+      {
+        const SizeType node = m_nodes_stack.back();
+        m_nodes_stack.pop_back();
+        for (SizeType arc : m_tree_arcs[node])
+        {
+          if (arc == m_parent_arc[node])
+            continue;
+          const bool is_outgoing = m_tail[arc] == node;
+          const SizeType child = is_outgoing ? m_head[arc] : m_tail[arc];
+          m_parent[child] = node;
+          m_parent_arc[child] = arc;
+          m_depth[child] = m_depth[node] + 1;
+          m_potential[child] = is_outgoing ? m_potential[node] - m_cost[arc] : m_potential[node] + m_cost[arc];
+          m_nodes_stack.push_back(child);
+        }
+      }
+    }
+
+    // Block search : the most violating arc of the first block containing any violating one
+    SizeType SelectEntering()
+    {
+      const SizeType arcs_count = m_cost.size();
+      SizeType best_arc = npos;
+      double best_reduced_cost = -m_tolerance;
+      for (SizeType scanned = 0, in_block = 0; scanned < arcs_count; ++scanned)
+      {
+        if (!m_is_basic[m_next_arc])
+        {
+          const double reduced_cost = ReducedCost(m_next_arc);
+          if (reduced_cost < best_reduced_cost)
+          {
+            best_reduced_cost = reduced_cost;
+            best_arc = m_next_arc;
+          }
+        }
+        m_next_arc = m_next_arc + 1 == arcs_count ? 0 : m_next_arc + 1;
+        if (++in_block == m_block_size)
+        {
+          if (best_arc != npos)
+            return best_arc;
+          in_block = 0;
+        }
+      }
+      return best_arc;
+    }
+
+    // Flow goes along the entering arc from x to y and back to x along the tree path through the join of both ends.
+    // Among the blocking arcs the last one met from the join in the direction of flow leaves, which keeps the tree
+    // strongly feasible and so rules out cycling on degenerate pivots
+    void Pivot(SizeType i_entering)
+    {
+      const SizeType x = m_tail[i_entering];
+      const SizeType y = m_head[i_entering];
+      m_path_arcs.clear();
+      m_y_side_arcs.clear();
+      for (SizeType from_x = x, from_y = y; from_x != from_y;)
+      {
+        if (m_depth[from_x] >= m_depth[from_y])
+        {
+          m_path_arcs.push_back(m_parent_arc[from_x]);
+          from_x = m_parent[from_x];
+        }
+        else
+        {
+          m_y_side_arcs.push_back(m_parent_arc[from_y]);
+          from_y = m_parent[from_y];
+        }
+      }
+      // x side arcs are collected from x up to the join, they are passed down in the direction of flow
+      std::reverse(m_path_arcs.begin(), m_path_arcs.end());
+      m_x_side_count = m_path_arcs.size();
+      m_path_arcs.insert(m_path_arcs.end(), m_y_side_arcs.cbegin(), m_y_side_arcs.cend());
+      double theta = std::numeric_limits<double>::infinity();
+      SizeType leaving_position = npos;
+      for (SizeType position = 0; position < m_path_arcs.size(); ++position)
+      {
+        if (IsForward(position))
+          continue;
+        const double flow = m_flow[m_path_arcs[position]];
+        if (flow <= theta)
+        {
+          theta = flow;
+          leaving_position = position;
+        }
+      }
+      for (SizeType position = 0; position < m_path_arcs.size(); ++position)
+        m_flow[m_path_arcs[position]] += IsForward(position) ? theta : -theta;
+      m_flow[i_entering] = theta;
+
+      // Subtree below the leaving arc is hung on the other end of the entering arc
+      const SizeType leaving = m_path_arcs[leaving_position];
+      const bool is_x_side = leaving_position < m_x_side_count;
+      const SizeType hung_node = is_x_side ? x : y;
+      const SizeType new_parent = is_x_side ? y : x;
+      UnlinkArc(leaving);
+      LinkArc(i_entering);
+      m_parent[hung_node] = new_parent;
+      m_parent_arc[hung_node] = i_entering;
+      m_depth[hung_node] = m_depth[new_parent] + 1;
+      m_potential[hung_node] = is_x_side ? m_potential[y] + m_cost[i_entering] : m_potential[x] - m_cost[i_entering];
+      RebuildSubtree(hung_node);
+    }
+
+    // Arc at the position of the path is passed down to x on the x side and up from y on the other one
+    bool IsForward(SizeType i_position) const
+    {
+      const SizeType arc = m_path_arcs[i_position];
+      return i_position < m_x_side_count ? m_parent_arc[m_head[arc]] == arc : m_parent_arc[m_tail[arc]] == arc;
+    }
+
+    const SparseTransportInformation& m_data;
+    SizeType m_rows_count;
+    SizeType m_columns_count;
+    SizeType m_routes_count;
+    SizeType m_root;
+    SizeType m_block_size;
+    double m_tolerance;
+    SizeType m_next_arc = 0;
+
+    Vector<SizeType> m_tail;
+    Vector<SizeType> m_head;
+    Vector<double> m_cost;
+    Vector<double> m_flow;
+    Vector<std::uint8_t> m_is_basic;
+
+    Vector<Vector<SizeType>> m_tree_arcs;
+    Vector<SizeType> m_parent;
+    Vector<SizeType> m_parent_arc;
+    Vector<SizeType> m_depth;
+    Vector<double> m_potential;
+
+    Vector<SizeType> m_nodes_stack;
+    Vector<SizeType> m_path_arcs;
+    Vector<SizeType> m_y_side_arcs;
+    SizeType m_x_side_count = 0;
+  };
+}
+
+namespace TransportTask
+{
+  SparseSolutionInfo GetOptimalSolution(const SparseTransportInformation& i_data)
+  {
+    SparseNetworkSimplex network(i_data);
+    return network.Solve();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include "SparseTask.h"
+#include "ExportHeader.h"
+
+namespace TransportTask
+{
+  struct SparseSolutionInfo
+  {
+    // Flows of the routes in the order of SparseTransportInformation
+    Vector<double> flows;
+    // Zero potential of the first row, the reduced cost of route (i, j) is cost - (m_rows[i] + m_columns[j])
+    MatrixPotentials final_potentials{ 0, 0 };
+    double objective = 0.0;
+    SizeType iterations_count = 0;
+  };
+
+  // Network simplex over the allowed routes : the basis tree gets a root node linked with every line by artificial
+  // routes of big cost, which carry the quantities the minimal cost plan over the routes couldn't place. Potentials and
+  // pricing visit the routes only, so every iteration costs O(routes count + m + n).
+  // Throws if the allowed routes can't carry the resources to the requirements
+  SOLVER_API SparseSolutionInfo GetOptimalSolution(const SparseTransportInformation& i_data);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "SparseTask.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace TransportTask
+{
+  SparseTransportInformation::SparseTransportInformation(const Vector<SparseRoute>& i_routes, const Vector<double>& i_resources,
+                                                         const Vector<double>& i_requirements)
+    :m_requirements{ i_requirements }
+    ,m_resources{ i_resources }
+  {
+    const SizeType given_rows_count = m_resources.size();
+    const SizeType given_columns_count = m_requirements.size();
+    const double requirements_sum = std::accumulate(m_requirements.cbegin(), m_requirements.cend(), 0.0);
+    const double resources_sum = std::accumulate(m_resources.cbegin(), m_resources.cend(), 0.0);
+    // Fictive routes are appended after the check, so a given route can't reach the fictive line
+    for (const auto& route : i_routes)
+    {
+      if (route.row >= given_rows_count || route.column >= given_columns_count)
+        throw std::runtime_error{ "Route is out of the task !" };
+    }
+    auto routes = i_routes;
+    if (resources_sum > requirements_sum)
+    {
+      m_state = ResourcesState::Overflow;
+      m_requirements.push_back(resources_sum - requirements_sum);
+      for (SizeType i = 0; i < given_rows_count; ++i)
+        routes.push_back({ i, given_columns_count, 0.0 });
+    }
+    else if (requirements_sum > resources_sum)
+    {
+      m_state = ResourcesState::Sufficient;
+      m_resources.push_back(requirements_sum - resources_sum);
+      for (SizeType j = 0; j < given_columns_count; ++j)
+        routes.push_back({ given_rows_count, j, 0.0 });
+    }
+
+    const SizeType rows_count = m_resources.size();
+    std::sort(routes.begin(), routes.end(), [](const SparseRoute& lhs, const SparseRoute& rhs)
+    {
+      return lhs.row < rhs.row || (lhs.row == rhs.row && lhs.column < rhs.column);
+    });
+    m_row_offsets.assign(rows_count + 1, 0);
+    m_route_columns.reserve(routes.size());
+    m_route_costs.reserve(routes.size());
+    for (SizeType k = 0; k < routes.size(); ++k)
+    {
+      const auto& route = routes[k];
+      if (k > 0 && routes[k - 1].row == route.row && routes[k - 1].column == route.column)
+        throw std::runtime_error{ "Route is given twice !" };
+      m_route_columns.push_back(route.column);
+      m_route_costs.push_back(route.cost);
+      ++m_row_offsets[route.row + 1];
+    }
+    std::partial_sum(m_row_offsets.cbegin(), m_row_offsets.cend(), m_row_offsets.begin());
+  }
+
+  std::optional<std::string> SparseTransportInformation::GetMessageForState() const
+  {
+    if (m_state == ResourcesState::Overflow)
+      return "Last client is fictive and indicates unused resources";
+    if (m_state == ResourcesState::Sufficient)
+      return "Last source is fictive and indicates sufficient resources";
+    return std::nullopt;
+  }
+
+  SizeType SparseTransportInformation::GetRoutesCount() const
+  {
+    return m_route_columns.size();
+  }
+}
\ No newline at end of file
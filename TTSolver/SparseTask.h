@@ -0,0 +1,37 @@
+#pragma once
+#include "Utility.h"
+#include "ExportHeader.h"
+
+namespace TransportTask
+{
+  // Allowed route of the sparse task, the routes which aren't given are forbidden
+  struct SparseRoute
+  {
+    SizeType row;
+    SizeType column;
+    double cost;
+  };
+
+  // Task over the allowed routes only : routes are stored by rows (CSR), so memory grows with the routes count
+  // instead of m * n. Unbalanced tasks get the fictive row or column like TransportInformation,
+  // it is linked with every line of the other side by routes of zero cost
+  class SparseTransportInformation
+  {
+    enum class ResourcesState { Normal, Sufficient, Overflow };
+  public:
+    SOLVER_API SparseTransportInformation(const Vector<SparseRoute>& i_routes, const Vector<double>& i_resources, const Vector<double>& i_requirements);
+
+    SOLVER_API std::optional<std::string> GetMessageForState() const;
+
+    SOLVER_API SizeType GetRoutesCount() const;
+
+    // Routes of row i are [m_row_offsets[i], m_row_offsets[i + 1]) sorted by columns
+    Vector<SizeType> m_row_offsets;
+    Vector<SizeType> m_route_columns;
+    Vector<double> m_route_costs;
+    Vector<double> m_requirements;
+    Vector<double> m_resources;
+  private:
+    ResourcesState m_state = ResourcesState::Normal;
+  };
+}
\ No newline at end of file
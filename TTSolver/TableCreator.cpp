@@ -1,9 +1,9 @@
 #include "pch.h"
 #include "TableCreator.h"
-#include "PotentialCalculator.h"
-#include <set>
+#include "DisjointSets.h"
 #include <algorithm>
 #include <numeric>
+#include <queue>
 #include <stdexcept>
 
 using namespace TransportTask;
@@ -26,159 +26,171 @@ namespace
     io_resources[row] -= investment;
   }
 
-  struct VogelIndex
+  // Two cheapest cells of the row or column among the live lines crossing it
+  struct VogelLine
   {
-    VogelIndex(SizeType i_index, double i_min_dif, bool i_is_row)
-      :index{ i_index }
-      , min_diff{ i_min_dif }
-      , is_row{ i_is_row }
-    {}
+    SizeType first_index = 0;
+    SizeType second_index = 0;
+    double first_cost = infinity;
+    double second_cost = infinity;
+    SizeType version = 0;
+    bool is_live = true;
 
-    SizeType index;
-    double min_diff;
+    double Penalty() const
+    {
+      return second_cost == infinity ? 0.0 : second_cost - first_cost;
+    }
+  };
+
+  struct VogelPenalty
+  {
+    double penalty;
+    double min_cost;
     bool is_row;
+    SizeType index;
+    SizeType version;
   };
 
-  PairOf<SizeType> GetBestIndexPair(const Vector<VogelIndex>& i_filtered_indexes,
-                                    const Matrix<double> &i_costs_matrix,
-                                    const Vector<double> &i_requirements,
-                                    const Vector<double> &i_resources)
+  // Biggest penalty first, then the cheapest cell, then rows before columns and lower indexes first
+  bool IsLowerPriority(const VogelPenalty& lhs, const VogelPenalty& rhs)
   {
-    PairOf<SizeType> pivot_indexes;
-    double best_value = infinity;
-    for (const auto& element_description : i_filtered_indexes)
+    if (lhs.penalty != rhs.penalty)
+      return lhs.penalty < rhs.penalty;
+    if (lhs.min_cost != rhs.min_cost)
+      return lhs.min_cost > rhs.min_cost;
+    if (lhs.is_row != rhs.is_row)
+      return rhs.is_row;
+    return lhs.index > rhs.index;
+  }
+
+  class VogelPenalties
+  {
+  public:
+    VogelPenalties(const Matrix<double>& i_costs_matrix)
+      :m_costs_matrix{ i_costs_matrix }
+      ,m_transposed_costs(i_costs_matrix.GetColumnsCount(), i_costs_matrix.GetRowsCount())
+      ,m_rows(i_costs_matrix.GetRowsCount())
+      ,m_columns(i_costs_matrix.GetColumnsCount())
+      ,m_queue(IsLowerPriority)
     {
-      if (element_description.is_row)
+      // Columns are rescanned as often as rows, so they are kept contiguous too
+      constexpr SizeType block_size = 64;
+      for (SizeType block_row = 0; block_row < m_rows.size(); block_row += block_size)
       {
-        const SizeType row_index = element_description.index;
-        SizeType min_index;
-        double min_value = infinity;
-        for (SizeType j = 0; j < i_costs_matrix.front().size(); ++j)
+        for (SizeType block_column = 0; block_column < m_columns.size(); block_column += block_size)
         {
-          if (i_resources[row_index] != 0 && i_requirements[j] != 0 && i_costs_matrix[row_index][j] < min_value)
+          for (SizeType i = block_row; i < std::min(block_row + block_size, m_rows.size()); ++i)
           {
-            min_value = i_costs_matrix[row_index][j];
-            min_index = j;
+            for (SizeType j = block_column; j < std::min(block_column + block_size, m_columns.size()); ++j)
+              m_transposed_costs[j][i] = i_costs_matrix[i][j];
           }
         }
-        if (best_value > min_value)
-        {
-          pivot_indexes = std::make_pair(row_index, min_index);
-          best_value = min_value;
-        }
       }
-      else
+      for (SizeType i = 0; i < m_rows.size(); ++i)
+        Update(true, i);
+      for (SizeType j = 0; j < m_columns.size(); ++j)
+        Update(false, j);
+    }
+
+    OptionalPair<SizeType> GetBestCell()
+    {
+      while (!m_queue.empty())
       {
-        const SizeType column_index = element_description.index;
-        SizeType min_row_index;
-        double min_value = infinity;
-        for (SizeType i = 0; i < i_costs_matrix.size(); ++i)
+        const VogelPenalty top = m_queue.top();
+        const VogelLine& line = top.is_row ? m_rows[top.index] : m_columns[top.index];
+        if (line.is_live && line.version == top.version)
         {
-          if (i_resources[i] != 0 && i_requirements[column_index] != 0 && i_costs_matrix[i][column_index] < min_value)
-          {
-            min_value = i_costs_matrix[i][column_index];
-            min_row_index = i;
-          }
-        }
-        if (best_value > min_value)
-        {
-          pivot_indexes = std::make_pair(min_row_index, column_index);
-          best_value = min_value;
+          if (top.is_row)
+            return std::make_pair(top.index, line.first_index);
+          return std::make_pair(line.first_index, top.index);
         }
+        m_queue.pop();
       }
+      return std::nullopt;
     }
-    return pivot_indexes;
-  }
 
-  OptionalPair<SizeType> GetApproximationElementIndex(const Matrix<double>& i_costs_matrix,
-                                                      const Vector<double>& i_resources,
-                                                      const Vector<double>& i_requirements)
-  {
-    Vector<VogelIndex> processed_elements;
-    for (SizeType i = 0; i < i_costs_matrix.size(); ++i)// Foreach row
+    void RemoveRow(SizeType i_row)
+    {
+      RemoveLine(m_rows[i_row], m_columns, false, i_row);
+    }
+
+    void RemoveColumn(SizeType i_column)
+    {
+      RemoveLine(m_columns[i_column], m_rows, true, i_column);
+    }
+  private:
+    // Only the crossing lines whose two cheapest cells lie on the removed line are recalculated
+    void RemoveLine(VogelLine& io_line, const Vector<VogelLine>& i_crossing_lines, bool i_crossing_rows, SizeType i_index)
     {
-      if (i_resources[i] != 0)
+      io_line.is_live = false;
+      for (SizeType k = 0; k < i_crossing_lines.size(); ++k)
       {
-        PairOf<double> row_diff{ infinity, infinity };
-        for (SizeType j = 0; j < i_costs_matrix[i].size(); ++j)
-        {
-          if (i_requirements[j] != 0)
-          {
-            if (i_costs_matrix[i][j] < row_diff.first)
-            {
-              row_diff.second = row_diff.first;
-              row_diff.first = i_costs_matrix[i][j];
-            }
-            else if (i_costs_matrix[i][j] < row_diff.second)
-            {
-              row_diff.second = i_costs_matrix[i][j];
-            }
-          }
-        }
-        if (row_diff.first != infinity)
-        {
-          if (row_diff.second == infinity)
-            processed_elements.emplace_back(i, 0, true);
-          else
-            processed_elements.emplace_back(i, row_diff.second - row_diff.first, true);
-        }
+        const VogelLine& crossing_line = i_crossing_lines[k];
+        if (crossing_line.is_live && crossing_line.first_cost != infinity
+            && (crossing_line.first_index == i_index || (crossing_line.second_cost != infinity && crossing_line.second_index == i_index)))
+          Update(i_crossing_rows, k);
       }
     }
 
-    for (SizeType j = 0; j < i_costs_matrix.front().size(); ++j)
+    void Update(bool i_is_row, SizeType i_index)
     {
-      if (i_requirements[j] != 0)
+      VogelLine& line = i_is_row ? m_rows[i_index] : m_columns[i_index];
+      const Vector<VogelLine>& crossing_lines = i_is_row ? m_columns : m_rows;
+      const auto line_costs = (i_is_row ? m_costs_matrix : m_transposed_costs)[i_index];
+      line.first_cost = line.second_cost = infinity;
+      for (SizeType k = 0; k < crossing_lines.size(); ++k)
       {
-        PairOf<double> column_diff{ infinity, infinity };
-        for (SizeType i = 0; i < i_costs_matrix.size(); ++i)
+        if (!crossing_lines[k].is_live)
+          continue;
+        const double cost = line_costs[k];
+        if (cost < line.first_cost)
         {
-          if (i_resources[i] != 0)
-          {
-            if (i_costs_matrix[i][j] < column_diff.first)
-            {
-              column_diff.second = column_diff.first;
-              column_diff.first = i_costs_matrix[i][j];
-            }
-            else if (i_costs_matrix[i][j] < column_diff.second)
-            {
-              column_diff.second = i_costs_matrix[i][j];
-            }
-          }
+          line.second_cost = line.first_cost;
+          line.second_index = line.first_index;
+          line.first_cost = cost;
+          line.first_index = k;
         }
-        if (column_diff.first != infinity)
+        else if (cost < line.second_cost)
         {
-          if (column_diff.second == infinity)
-            processed_elements.emplace_back(j, 0, false);
-          else
-            processed_elements.emplace_back(j, column_diff.second - column_diff.first, false);
+          line.second_cost = cost;
+          line.second_index = k;
         }
       }
+      ++line.version;
+      if (line.first_cost != infinity)
+        m_queue.push({ line.Penalty(), line.first_cost, i_is_row, i_index, line.version });
     }
-    if (!processed_elements.empty())
-    {
-      const double max_diff = std::max_element(processed_elements.cbegin(), processed_elements.cend(), [](const VogelIndex& lhs, const VogelIndex& rhs)
-      {
-        return lhs.min_diff < rhs.min_diff;
-      })->min_diff;
-      auto first_invalid = std::remove_if(processed_elements.begin(), processed_elements.end(), [&max_diff](const VogelIndex& index)
-      {
-        return index.min_diff < max_diff;
-      });
-      processed_elements.erase(first_invalid, processed_elements.end());
-      return GetBestIndexPair(processed_elements, i_costs_matrix, i_requirements, i_resources);
-    }
-    return std::nullopt;
-  }
+
+    const Matrix<double>& m_costs_matrix;
+    Matrix<double> m_transposed_costs;
+    Vector<VogelLine> m_rows;
+    Vector<VogelLine> m_columns;
+    std::priority_queue<VogelPenalty, Vector<VogelPenalty>, decltype(&IsLowerPriority)> m_queue;
+  };
 
   void VogelFormatter(Matrix<double>& io_edited_matrix, const TransportInformation& i_data)
   {
     auto resources = i_data.m_resources;
     auto requirements = i_data.m_requirements;
-    auto indexes = GetApproximationElementIndex(i_data.m_costs_matrix, resources, requirements);
-    while (indexes)
+    VogelPenalties penalties(i_data.m_costs_matrix);
+    for (SizeType i = 0; i < resources.size(); ++i)
+    {
+      if (resources[i] == 0)
+        penalties.RemoveRow(i);
+    }
+    for (SizeType j = 0; j < requirements.size(); ++j)
+    {
+      if (requirements[j] == 0)
+        penalties.RemoveColumn(j);
+    }
+    while (auto indexes = penalties.GetBestCell())
     {
       MakeGreedyInvestment(io_edited_matrix, requirements, resources, indexes.value());
-      indexes = GetApproximationElementIndex(i_data.m_costs_matrix, resources, requirements);
+      auto [row, column] = indexes.value();
+      if (resources[row] == 0)
+        penalties.RemoveRow(row);
+      if (requirements[column] == 0)
+        penalties.RemoveColumn(column);
     }
   }
 
@@ -210,14 +222,15 @@ namespace
 
   void MarkMinimalElements(Matrix<int>& io_marks_matrix, const Matrix<double> &i_costs_matrix)
   {
-    const SizeType rows_count = io_marks_matrix.size();
-    const SizeType columns_count = io_marks_matrix.front().size();
+    const SizeType rows_count = io_marks_matrix.GetRowsCount();
+    const SizeType columns_count = io_marks_matrix.GetColumnsCount();
     for (SizeType i = 0; i < rows_count; ++i)
     {
+      const auto row_costs = i_costs_matrix[i];
       SizeType min_index = 0;
       for (SizeType j = 1; j < columns_count; ++j)
       {
-        if (i_costs_matrix[i][j] < i_costs_matrix[i][min_index])
+        if (row_costs[j] < row_costs[min_index])
           min_index = j;
       }
       ++io_marks_matrix[i][min_index];
@@ -225,10 +238,11 @@ namespace
 
     for (SizeType j = 0; j < columns_count; ++j)
     {
+      const auto column_costs = i_costs_matrix.Column(j);
       SizeType min_index = 0;
       for (SizeType i = 1; i < rows_count; ++i)
       {
-        if (i_costs_matrix[i][j] < i_costs_matrix[min_index][j])
+        if (column_costs[i] < column_costs[min_index])
           min_index = i;
       }
       ++io_marks_matrix[min_index][j];
@@ -237,9 +251,9 @@ namespace
 
   void DoubleMarksFormatter(Matrix<double>& io_edited_matrix, const TransportInformation& i_data)
   {
-    const SizeType rows_count = io_edited_matrix.size();
-    const SizeType columns_count = io_edited_matrix.front().size();
-    Matrix<int> marks_matrix(rows_count, Vector<int>(columns_count));
+    const SizeType rows_count = io_edited_matrix.GetRowsCount();
+    const SizeType columns_count = io_edited_matrix.GetColumnsCount();
+    Matrix<int> marks_matrix(rows_count, columns_count);
     MarkMinimalElements(marks_matrix, i_data.m_costs_matrix);
     using ElementInfo = std::pair<PairOf<SizeType>, int>;
     Vector<ElementInfo> processed_elements;
@@ -290,8 +304,8 @@ namespace
   void NorthWestFormatter(Matrix<double>& io_edited_matrix, const Vector<double>& i_resources, const Vector<double>& i_requirements)
   {
     auto resources = i_requirements;
-    const SizeType processed_height = io_edited_matrix.size();
-    const SizeType processed_width = io_edited_matrix.front().size();
+    const SizeType processed_height = io_edited_matrix.GetRowsCount();
+    const SizeType processed_width = io_edited_matrix.GetColumnsCount();
     SizeType processed_column_index = 0;
     double wasted_for_current_row = 0;
     for (SizeType row = 0; row < processed_height; ++row)
@@ -310,42 +324,413 @@ namespace
     }
   }
 
+  // Joins components of the filled cells with zero valued cells, cheapest first, until they form spanning tree
   bool EliminateDegeneracy(Matrix<double>& io_formatted_matrix, const TransportInformation& i_data)
   {
-    SizeType count_of_filled_elements = 0;
-    for (const auto& row : io_formatted_matrix)
+    const SizeType sources_count = io_formatted_matrix.GetRowsCount();
+    const SizeType clients_count = io_formatted_matrix.GetColumnsCount();
+    DisjointSets components(sources_count + clients_count);
+    for (SizeType i = 0; i < sources_count; ++i)
+    {
+      const auto row = io_formatted_matrix[i];
+      for (SizeType j = 0; j < clients_count; ++j)
+      {
+        if (row[j] != empty_value && !components.Unite(i, sources_count + j))
+          return false;
+      }
+    }
+    if (components.GetSetsCount() == 1)
+      return true;
+
+    // Boruvka rounds: every component takes its cheapest outgoing cell, ties are broken by the cell index,
+    // so the result equals cheapest-first completion without sorting all free cells
+    const SizeType nodes_count = sources_count + clients_count;
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    Vector<SizeType> node_components(nodes_count);
+    Vector<PairOf<SizeType>> cheapest_cells(nodes_count);
+    constexpr SizeType no_cell = std::numeric_limits<SizeType>::max();
+    while (components.GetSetsCount() > 1)
     {
-      for (double value : row)
+      for (SizeType node = 0; node < nodes_count; ++node)
+        node_components[node] = components.Find(node);
+      std::fill(cheapest_cells.begin(), cheapest_cells.end(), std::make_pair(no_cell, no_cell));
+      auto update_cheapest = [&costs_matrix](PairOf<SizeType>& io_cheapest, SizeType i_row, SizeType i_column, double i_cost)
       {
-        if (value != empty_value)
+        if (io_cheapest.first == no_cell || i_cost < costs_matrix[io_cheapest.first][io_cheapest.second])
+          io_cheapest = std::make_pair(i_row, i_column);
+      };
+      for (SizeType i = 0; i < sources_count; ++i)
+      {
+        const SizeType row_component = node_components[i];
+        const auto row_costs = costs_matrix[i];
+        for (SizeType j = 0; j < clients_count; ++j)
         {
-          ++count_of_filled_elements;
+          const SizeType column_component = node_components[sources_count + j];
+          if (row_component != column_component)
+          {
+            update_cheapest(cheapest_cells[row_component], i, j, row_costs[j]);
+            update_cheapest(cheapest_cells[column_component], i, j, row_costs[j]);
+          }
         }
       }
+      for (const auto& [row, column] : cheapest_cells)
+      {
+        if (row != no_cell && components.Unite(row, sources_count + column))
+          io_formatted_matrix[row][column] = 0.0;
+      }
     }
-    const SizeType sources_count = io_formatted_matrix.size();
-    const SizeType clients_count = io_formatted_matrix.front().size();
-    if (count_of_filled_elements == sources_count + clients_count - 2)
+    return true;
+  }
+
+  constexpr double warm_start_tolerance = 1e-9;
+  constexpr double capacity_tolerance = 1e-9;
+
+  // Flows of the basic cells are fixed by the quantities : a leaf of the basis tree sends all its remaining quantity
+  // through its only cell. Negative flows are written as they are, returns false if the cells don't form a spanning tree
+  bool CalculateTreeFlows(Matrix<double>& io_basis, const Vector<PairOf<SizeType>>& i_basic_cells, const TransportInformation& i_data)
+  {
+    const SizeType rows_count = i_data.m_resources.size();
+    const SizeType nodes_count = rows_count + i_data.m_requirements.size();
+    Vector<double> remaining(i_data.m_resources);
+    remaining.insert(remaining.end(), i_data.m_requirements.cbegin(), i_data.m_requirements.cend());
+    Vector<SizeType> degree(nodes_count, 0);
+    // Xor of the indexes of the unprocessed cells of the node, the last one is left when the node becomes a leaf
+    Vector<SizeType> cells_xor(nodes_count, 0);
+    for (SizeType k = 0; k < i_basic_cells.size(); ++k)
     {
-      std::set<PairOf<SizeType>> used_combinations;
-      const SizeType available_combinations_count = sources_count * clients_count - count_of_filled_elements - 1;
-      while (used_combinations.size() != available_combinations_count)
+      auto [row, column] = i_basic_cells[k];
+      ++degree[row];
+      ++degree[rows_count + column];
+      cells_xor[row] ^= k;
+      cells_xor[rows_count + column] ^= k;
+    }
+    Vector<SizeType> leaves;
+    for (SizeType node = 0; node < nodes_count; ++node)
+    {
+      if (degree[node] == 1)
+        leaves.push_back(node);
+    }
+    SizeType assigned_count = 0;
+    while (!leaves.empty())
+    {
+      const SizeType leaf = leaves.back();
+      leaves.pop_back();
+      if (degree[leaf] != 1)
+        continue;
+      const SizeType cell_index = cells_xor[leaf];
+      auto [row, column] = i_basic_cells[cell_index];
+      const SizeType other = leaf == row ? rows_count + column : row;
+      const double flow = remaining[leaf];
+      io_basis[row][column] = flow < -warm_start_tolerance ? flow : std::max(flow, 0.0);
+      ++assigned_count;
+      remaining[other] -= flow;
+      degree[leaf] = 0;
+      cells_xor[other] ^= cell_index;
+      if (--degree[other] == 1)
+        leaves.push_back(other);
+    }
+    return assigned_count == i_basic_cells.size();
+  }
+
+  // Cells crossing the lines with something left are taken by cost, every investment closes a row, a column or the cell
+  void FillLeftLines(Matrix<double>& io_plan, Vector<double>& io_resources, Vector<double>& io_requirements, const TransportInformation& i_data)
+  {
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    Vector<PairOf<SizeType>> left_cells;
+    for (SizeType i = 0; i < io_resources.size(); ++i)
+    {
+      if (io_resources[i] == 0)
+        continue;
+      for (SizeType j = 0; j < io_requirements.size(); ++j)
       {
-        auto checked_indexes = std::make_pair(rand() % sources_count, rand() % clients_count);
-        auto it = used_combinations.find(checked_indexes);
-        auto [row, column] = checked_indexes;
-        if (io_formatted_matrix[row][column] == empty_value && it == used_combinations.end())
+        if (io_requirements[j] != 0)
+          left_cells.emplace_back(i, j);
+      }
+    }
+    std::sort(left_cells.begin(), left_cells.end(), [&costs_matrix](const PairOf<SizeType>& lhs, const PairOf<SizeType>& rhs)
+    {
+      const double lhs_cost = costs_matrix[lhs.first][lhs.second];
+      const double rhs_cost = costs_matrix[rhs.first][rhs.second];
+      return lhs_cost < rhs_cost || (lhs_cost == rhs_cost && lhs < rhs);
+    });
+    for (const auto& [row, column] : left_cells)
+    {
+      const double flow = io_plan[row][column] == empty_value ? 0.0 : io_plan[row][column];
+      const double investment = std::min(GreedyInvestmentAmount(io_requirements[column], io_resources[row]), i_data.CapacityAt(row, column) - flow);
+      if (investment <= 0)
+        continue;
+      io_plan[row][column] = flow + investment;
+      io_requirements[column] -= investment;
+      io_resources[row] -= investment;
+    }
+  }
+
+  // Quantities the capacities kept from the greedy passes go along augmenting paths : a row reaches a column through
+  // a cell below its capacity and a column goes back to a row through a cell with flow
+  void RouteLeftQuantities(Matrix<double>& io_plan, Vector<double>& io_resources, Vector<double>& io_requirements, const TransportInformation& i_data)
+  {
+    const SizeType rows_count = io_resources.size();
+    const SizeType columns_count = io_requirements.size();
+    const double tolerance = capacity_tolerance * std::max(1.0, std::accumulate(i_data.m_resources.cbegin(), i_data.m_resources.cend(), 0.0));
+    constexpr SizeType no_node = std::numeric_limits<SizeType>::max();
+    Vector<SizeType> predecessors(rows_count + columns_count);
+    Vector<SizeType> nodes_queue;
+    auto flow_at = [&io_plan](SizeType i_row, SizeType i_column)
+    {
+      return io_plan[i_row][i_column] == empty_value ? 0.0 : io_plan[i_row][i_column];
+    };
+    for (;;)
+    {
+      std::fill(predecessors.begin(), predecessors.end(), no_node);
+      nodes_queue.clear();
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        if (io_resources[i] > tolerance)
         {
-          io_formatted_matrix[row][column] = 0.0;
-          if (CalculatePotentials(i_data, io_formatted_matrix))
-            return true;
-          io_formatted_matrix[row][column] = empty_value;
-          used_combinations.insert(it, checked_indexes);
+          predecessors[i] = i;
+          nodes_queue.push_back(i);
+        }
+      }
+      if (nodes_queue.empty())
+        return;
+      SizeType reached_node = no_node;
+      for (SizeType k = 0; k < nodes_queue.size() && reached_node == no_node; ++k)
+      {
+        const SizeType node = nodes_queue[k];
+        if (node < rows_count)
+        {
+          for (SizeType j = 0; j < columns_count && reached_node == no_node; ++j)
+          {
+            if (predecessors[rows_count + j] != no_node || flow_at(node, j) >= i_data.CapacityAt(node, j))
+              continue;
+            predecessors[rows_count + j] = node;
+            if (io_requirements[j] > tolerance)
+              reached_node = rows_count + j;
+            nodes_queue.push_back(rows_count + j);
+          }
         }
+        else
+        {
+          for (SizeType i = 0; i < rows_count; ++i)
+          {
+            if (predecessors[i] == no_node && flow_at(i, node - rows_count) > 0.0)
+            {
+              predecessors[i] = node;
+              nodes_queue.push_back(i);
+            }
+          }
+        }
+      }
+      if (reached_node == no_node)
+        throw std::runtime_error{ "Capacities can't carry the resources !" };
+
+      double amount = io_requirements[reached_node - rows_count];
+      SizeType node = reached_node;
+      for (; predecessors[node] != node; node = predecessors[node])
+      {
+        const SizeType previous = predecessors[node];
+        if (node >= rows_count)
+          amount = std::min(amount, i_data.CapacityAt(previous, node - rows_count) - flow_at(previous, node - rows_count));
+        else
+          amount = std::min(amount, flow_at(node, previous - rows_count));
+      }
+      amount = std::min(amount, io_resources[node]);
+      io_resources[node] -= amount;
+      io_requirements[reached_node - rows_count] -= amount;
+      for (node = reached_node; predecessors[node] != node; node = predecessors[node])
+      {
+        const SizeType previous = predecessors[node];
+        if (node >= rows_count)
+          io_plan[previous][node - rows_count] = flow_at(previous, node - rows_count) + amount;
+        else
+          io_plan[node][previous - rows_count] = flow_at(node, previous - rows_count) - amount;
       }
-      return false;
     }
-    else return count_of_filled_elements == sources_count + clients_count - 1;
+  }
+
+  // Tree flows of the new quantities are the previous flows with every change of a quantity pushed along its tree path.
+  // Cells which went negative are cancelled and stay as zero cells : their rows and columns ship too much, so the
+  // surplus is taken from the most expensive cells of these lines, preferring cells whose other line ships too much
+  // as well. The lines left short get their quantities from the cheapest cells
+  void RepairPlan(Matrix<double>& io_plan, const Vector<PairOf<SizeType>>& i_basic_cells, const TransportInformation& i_data)
+  {
+    const SizeType rows_count = i_data.m_resources.size();
+    const SizeType columns_count = i_data.m_requirements.size();
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    // Surplus of every line, rows come first
+    Vector<double> surpluses(rows_count + columns_count, 0.0);
+    Vector<Vector<SizeType>> line_cells(rows_count + columns_count);
+    for (SizeType k = 0; k < i_basic_cells.size(); ++k)
+    {
+      auto [row, column] = i_basic_cells[k];
+      line_cells[row].push_back(k);
+      line_cells[rows_count + column].push_back(k);
+      if (io_plan[row][column] < 0.0)
+      {
+        surpluses[row] -= io_plan[row][column];
+        surpluses[rows_count + column] -= io_plan[row][column];
+        io_plan[row][column] = 0.0;
+      }
+    }
+    auto cut_surplus = [&](SizeType i_line)
+    {
+      auto& cells = line_cells[i_line];
+      auto other_line_of = [&i_basic_cells, i_line, rows_count](SizeType i_cell)
+      {
+        auto [row, column] = i_basic_cells[i_cell];
+        return i_line < rows_count ? rows_count + column : row;
+      };
+      std::sort(cells.begin(), cells.end(), [&](SizeType lhs, SizeType rhs)
+      {
+        const bool lhs_has_surplus = surpluses[other_line_of(lhs)] > 0.0;
+        const bool rhs_has_surplus = surpluses[other_line_of(rhs)] > 0.0;
+        if (lhs_has_surplus != rhs_has_surplus)
+          return lhs_has_surplus;
+        const double lhs_cost = costs_matrix[i_basic_cells[lhs].first][i_basic_cells[lhs].second];
+        const double rhs_cost = costs_matrix[i_basic_cells[rhs].first][i_basic_cells[rhs].second];
+        return lhs_cost > rhs_cost || (lhs_cost == rhs_cost && lhs < rhs);
+      });
+      for (SizeType k = 0; k < cells.size() && surpluses[i_line] > 0.0; ++k)
+      {
+        auto [row, column] = i_basic_cells[cells[k]];
+        const double cut = std::min(io_plan[row][column], surpluses[i_line]);
+        io_plan[row][column] -= cut;
+        surpluses[i_line] -= cut;
+        surpluses[other_line_of(cells[k])] -= cut;
+      }
+    };
+    for (SizeType line = 0; line < rows_count + columns_count; ++line)
+    {
+      if (surpluses[line] > warm_start_tolerance)
+        cut_surplus(line);
+    }
+
+    Vector<double> resources(rows_count);
+    Vector<double> requirements(columns_count);
+    for (SizeType i = 0; i < rows_count; ++i)
+      resources[i] = surpluses[i] < -warm_start_tolerance ? -surpluses[i] : 0.0;
+    for (SizeType j = 0; j < columns_count; ++j)
+      requirements[j] = surpluses[rows_count + j] < -warm_start_tolerance ? -surpluses[rows_count + j] : 0.0;
+    FillLeftLines(io_plan, resources, requirements, i_data);
+  }
+
+  // Path of the forest from i_from to i_to as list of nodes starting at i_to, empty if they aren't connected
+  Vector<SizeType> FindForestPath(const Vector<Vector<SizeType>>& i_adjacent_nodes, SizeType i_from, SizeType i_to,
+                                  Vector<SizeType>& io_predecessors)
+  {
+    constexpr SizeType no_node = std::numeric_limits<SizeType>::max();
+    std::fill(io_predecessors.begin(), io_predecessors.end(), no_node);
+    io_predecessors[i_from] = i_from;
+    Vector<SizeType> nodes_queue{ i_from };
+    for (SizeType k = 0; k < nodes_queue.size() && io_predecessors[i_to] == no_node; ++k)
+    {
+      for (SizeType neighbour : i_adjacent_nodes[nodes_queue[k]])
+      {
+        if (io_predecessors[neighbour] == no_node)
+        {
+          io_predecessors[neighbour] = nodes_queue[k];
+          nodes_queue.push_back(neighbour);
+        }
+      }
+    }
+    Vector<SizeType> path;
+    if (io_predecessors[i_to] == no_node)
+      return path;
+    for (SizeType node = i_to; node != i_from; node = io_predecessors[node])
+      path.push_back(node);
+    path.push_back(i_from);
+    return path;
+  }
+
+  // Cycles among the cells with flow are cancelled the way which doesn't raise the cost, the cells with flow left form a forest
+  Matrix<double> CancelPlanCycles(const TransportInformation& i_data, const Matrix<double>& i_plan, Vector<BasisCell>& o_saturated_cells)
+  {
+    const SizeType rows_count = i_data.m_resources.size();
+    const SizeType columns_count = i_data.m_requirements.size();
+    const auto& costs_matrix = i_data.m_costs_matrix;
+    Matrix<double> formatted_matrix(rows_count, columns_count, empty_value);
+    Vector<Vector<SizeType>> adjacent_nodes(rows_count + columns_count);
+    Vector<SizeType> predecessors(rows_count + columns_count);
+    o_saturated_cells.clear();
+    auto unlink = [&adjacent_nodes](SizeType i_first, SizeType i_second)
+    {
+      auto& first_list = adjacent_nodes[i_first];
+      first_list.erase(std::find(first_list.begin(), first_list.end(), i_second));
+      auto& second_list = adjacent_nodes[i_second];
+      second_list.erase(std::find(second_list.begin(), second_list.end(), i_first));
+    };
+    // Cells reaching their capacities leave the forest as saturated ones, cells reaching zero leave the plan
+    auto drop = [&](SizeType i_row, SizeType i_column, double i_flow)
+    {
+      if (i_flow > 0.0)
+        o_saturated_cells.push_back({ static_cast<std::uint32_t>(i_row), static_cast<std::uint32_t>(i_column), i_flow });
+    };
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        double flow = i_plan[i][j];
+        if (flow == empty_value || flow <= 0.0)
+          continue;
+        const double capacity = i_data.CapacityAt(i, j);
+        if (flow >= capacity)
+        {
+          drop(i, j, capacity);
+          continue;
+        }
+        // Path goes from the column to the row, when the new cell grows its cells are decreased and increased in turn
+        const auto path = FindForestPath(adjacent_nodes, rows_count + j, i, predecessors);
+        if (!path.empty())
+        {
+          constexpr SizeType no_edge = std::numeric_limits<SizeType>::max();
+          auto cell_of_edge = [&path, rows_count](SizeType i_edge)
+          {
+            return std::make_pair(std::min(path[i_edge], path[i_edge + 1]), std::max(path[i_edge], path[i_edge + 1]) - rows_count);
+          };
+          double cycle_cost = costs_matrix[i][j];
+          for (SizeType k = 0; k + 1 < path.size(); ++k)
+          {
+            auto [row, column] = cell_of_edge(k);
+            cycle_cost += k % 2 == 0 ? -costs_matrix[row][column] : costs_matrix[row][column];
+          }
+          // Cycle is cancelled the way which doesn't raise the cost, the cell reaching a bound leaves the forest
+          const bool is_growing = cycle_cost <= 0.0;
+          double theta = is_growing ? capacity - flow : flow;
+          SizeType leaving_edge = no_edge;
+          for (SizeType k = 0; k + 1 < path.size(); ++k)
+          {
+            auto [row, column] = cell_of_edge(k);
+            const double cell_flow = formatted_matrix[row][column];
+            const double room = (k % 2 == 0) == is_growing ? cell_flow : i_data.CapacityAt(row, column) - cell_flow;
+            if (room < theta)
+            {
+              theta = room;
+              leaving_edge = k;
+            }
+          }
+          const double shift = is_growing ? theta : -theta;
+          for (SizeType k = 0; k + 1 < path.size(); ++k)
+          {
+            auto [row, column] = cell_of_edge(k);
+            formatted_matrix[row][column] += k % 2 == 0 ? -shift : shift;
+          }
+          flow += shift;
+          if (leaving_edge == no_edge)
+          {
+            drop(i, j, flow);
+            continue;
+          }
+          auto [leaving_row, leaving_column] = cell_of_edge(leaving_edge);
+          drop(leaving_row, leaving_column, formatted_matrix[leaving_row][leaving_column]);
+          formatted_matrix[leaving_row][leaving_column] = empty_value;
+          unlink(path[leaving_edge], path[leaving_edge + 1]);
+        }
+        formatted_matrix[i][j] = flow;
+        adjacent_nodes[i].push_back(rows_count + j);
+        adjacent_nodes[rows_count + j].push_back(i);
+      }
+    }
+    return formatted_matrix;
   }
 }
 
@@ -369,7 +754,7 @@ namespace TransportTask
 
   Matrix<double> FormatTask(const TransportInformation& i_data, CreationMethod i_method)
   {
-    Matrix<double> formatted_matrix(i_data.m_resources.size(), Vector<double>(i_data.m_requirements.size(), empty_value));
+    Matrix<double> formatted_matrix(i_data.m_resources.size(), i_data.m_requirements.size(), empty_value);
     switch (i_method)
     {
     case CreationMethod::NorthWestAngle:
@@ -390,4 +775,130 @@ namespace TransportTask
 
     return formatted_matrix;
   }
+
+  std::optional<Matrix<double>> FormatTaskFromBasis(const TransportInformation& i_data, const Matrix<double>& i_previous_basis)
+  {
+    const SizeType rows_count = i_data.m_resources.size();
+    const SizeType columns_count = i_data.m_requirements.size();
+    if (i_previous_basis.GetRowsCount() != rows_count || i_previous_basis.GetColumnsCount() != columns_count)
+      return std::nullopt;
+
+    Vector<PairOf<SizeType>> basic_cells;
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (i_previous_basis[i][j] != empty_value)
+          basic_cells.emplace_back(i, j);
+      }
+    }
+    Matrix<double> formatted_matrix(rows_count, columns_count, empty_value);
+    if (basic_cells.size() != rows_count + columns_count - 1 || !CalculateTreeFlows(formatted_matrix, basic_cells, i_data))
+      return std::nullopt;
+    const bool is_feasible = std::all_of(basic_cells.cbegin(), basic_cells.cend(), [&formatted_matrix](const PairOf<SizeType>& cell)
+    {
+      return formatted_matrix[cell.first][cell.second] >= 0.0;
+    });
+    if (is_feasible)
+      return formatted_matrix;
+
+    RepairPlan(formatted_matrix, basic_cells, i_data);
+    Vector<BasisCell> saturated_cells;
+    formatted_matrix = CancelPlanCycles(i_data, formatted_matrix, saturated_cells);
+    // Previous cells left without flow are taken before the cheapest ones while they don't close a cycle
+    DisjointSets components(rows_count + columns_count);
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (formatted_matrix[i][j] != empty_value)
+          components.Unite(i, rows_count + j);
+      }
+    }
+    for (const auto& [row, column] : basic_cells)
+    {
+      if (formatted_matrix[row][column] == empty_value && components.Unite(row, rows_count + column))
+        formatted_matrix[row][column] = 0.0;
+    }
+    if (!EliminateDegeneracy(formatted_matrix, i_data))
+      throw std::runtime_error{ "Elimination of degeneracy failed !" };
+    return formatted_matrix;
+  }
+
+  Matrix<double> FormatTaskFromPlan(const TransportInformation& i_data, const Matrix<double>& i_plan)
+  {
+    Vector<BasisCell> saturated_cells;
+    return FormatTaskFromPlan(i_data, i_plan, saturated_cells);
+  }
+
+  Matrix<double> FormatTaskFromPlan(const TransportInformation& i_data, const Matrix<double>& i_plan, Vector<BasisCell>& o_saturated_cells)
+  {
+    auto formatted_matrix = CancelPlanCycles(i_data, i_plan, o_saturated_cells);
+    if (!EliminateDegeneracy(formatted_matrix, i_data))
+      throw std::runtime_error{ "Elimination of degeneracy failed !" };
+    // Saturated cells taken to complete the tree stay basic with their flows
+    auto first_basic = std::remove_if(o_saturated_cells.begin(), o_saturated_cells.end(), [&formatted_matrix](const BasisCell& cell)
+    {
+      if (formatted_matrix[cell.row][cell.column] == empty_value)
+        return false;
+      formatted_matrix[cell.row][cell.column] = cell.value;
+      return true;
+    });
+    o_saturated_cells.erase(first_basic, o_saturated_cells.end());
+    return formatted_matrix;
+  }
+
+  Matrix<double> FormatTaskFromApproximatePlan(const TransportInformation& i_data, const Matrix<double>& i_plan)
+  {
+    Vector<BasisCell> saturated_cells;
+    return FormatTaskFromApproximatePlan(i_data, i_plan, saturated_cells);
+  }
+
+  Matrix<double> FormatTaskFromApproximatePlan(const TransportInformation& i_data, const Matrix<double>& i_plan, Vector<BasisCell>& o_saturated_cells)
+  {
+    const SizeType rows_count = std::min(i_plan.GetRowsCount(), i_data.m_resources.size());
+    const SizeType columns_count = std::min(i_plan.GetColumnsCount(), i_data.m_requirements.size());
+    if (rows_count + 1 < i_data.m_resources.size() || columns_count + 1 < i_data.m_requirements.size()
+        || i_plan.GetRowsCount() > i_data.m_resources.size() || i_plan.GetColumnsCount() > i_data.m_requirements.size())
+      throw std::runtime_error{ "Plan doesn't belong to the task !" };
+
+    Vector<PairOf<SizeType>> flow_cells;
+    for (SizeType i = 0; i < rows_count; ++i)
+    {
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (i_plan[i][j] != empty_value && i_plan[i][j] > 0.0)
+          flow_cells.emplace_back(i, j);
+      }
+    }
+    std::sort(flow_cells.begin(), flow_cells.end(), [&i_plan](const PairOf<SizeType>& lhs, const PairOf<SizeType>& rhs)
+    {
+      const double lhs_flow = i_plan[lhs.first][lhs.second];
+      const double rhs_flow = i_plan[rhs.first][rhs.second];
+      return lhs_flow > rhs_flow || (lhs_flow == rhs_flow && lhs < rhs);
+    });
+    // Bigger flows are kept first, so the error of the plan is cut from its smallest cells
+    Matrix<double> feasible_plan(i_data.m_resources.size(), i_data.m_requirements.size(), empty_value);
+    auto resources = i_data.m_resources;
+    auto requirements = i_data.m_requirements;
+    for (const auto& [row, column] : flow_cells)
+    {
+      const double investment = std::min({ i_plan[row][column], i_data.CapacityAt(row, column),
+                                           GreedyInvestmentAmount(requirements[column], resources[row]) });
+      if (investment == 0)
+        continue;
+      feasible_plan[row][column] = investment;
+      requirements[column] -= investment;
+      resources[row] -= investment;
+    }
+    FillLeftLines(feasible_plan, resources, requirements, i_data);
+    if (i_data.IsCapacitated())
+      RouteLeftQuantities(feasible_plan, resources, requirements, i_data);
+    return FormatTaskFromPlan(i_data, feasible_plan, o_saturated_cells);
+  }
+
+  Matrix<double> FormatCapacitatedTask(const TransportInformation& i_data, CreationMethod i_method, Vector<BasisCell>& o_saturated_cells)
+  {
+    return FormatTaskFromApproximatePlan(i_data, FormatTask(i_data, i_method), o_saturated_cells);
+  }
 }
\ No newline at end of file
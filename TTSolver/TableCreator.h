@@ -1,6 +1,7 @@
 #pragma once
 #include "Utility.h"
 #include "ExportHeader.h"
+#include <optional>
 #include <string>
 
 namespace TransportTask
@@ -10,4 +11,30 @@ namespace TransportTask
   SOLVER_API std::string GetMethodName(CreationMethod i_method);
 
   SOLVER_API Matrix<double> FormatTask(const TransportInformation &i_data, CreationMethod i_method);
+
+  // Basis for a warm start : the previous basic cells are kept if their tree flows are feasible for the new quantities,
+  // otherwise only the cells which went negative are cancelled and their lines are repaired around them. Returns nullopt
+  // if sizes of the tasks differ or the previous basis isn't a spanning tree
+  std::optional<Matrix<double>> FormatTaskFromBasis(const TransportInformation& i_data, const Matrix<double>& i_previous_basis);
+
+  // Basis from a feasible plan : cycles among the cells with flow are cancelled the way which doesn't raise the cost,
+  // the rest is completed to spanning tree with the cheapest zero cells
+  Matrix<double> FormatTaskFromPlan(const TransportInformation& i_data, const Matrix<double>& i_plan);
+
+  // Cycles are cancelled within the capacities : cells reaching their capacities leave the basis as saturated ones
+  Matrix<double> FormatTaskFromPlan(const TransportInformation& i_data, const Matrix<double>& i_plan, Vector<BasisCell>& o_saturated_cells);
+
+  // Crossover of a plan which may miss the quantities, like a Sinkhorn plan or a plan of the user : flows are cut to the
+  // quantities taking bigger cells first, the rest goes to the cheapest cells and the result is passed to FormatTaskFromPlan.
+  // Plans without the fictive line of the balanced task are accepted
+  SOLVER_API Matrix<double> FormatTaskFromApproximatePlan(const TransportInformation& i_data, const Matrix<double>& i_plan);
+
+  // Capacitated tasks : flows are cut to the capacities too, the quantities they keep from the cheapest cells are sent
+  // along augmenting paths. Throws if the capacities can't carry the resources
+  SOLVER_API Matrix<double> FormatTaskFromApproximatePlan(const TransportInformation& i_data, const Matrix<double>& i_plan,
+                                                          Vector<BasisCell>& o_saturated_cells);
+
+  // Basis of the capacitated task : plan of the method is made feasible for the capacities like an approximate plan,
+  // non-basic cells carrying their capacities are put to o_saturated_cells
+  SOLVER_API Matrix<double> FormatCapacitatedTask(const TransportInformation& i_data, CreationMethod i_method, Vector<BasisCell>& o_saturated_cells);
 }
\ No newline at end of file
@@ -1,165 +1,211 @@
 #include "pch.h"
 #include "TaskSolver.h"
-#include "PotentialCalculator.h"
-#include <algorithm>
-#include <sstream>
-#include <string>
+#include "AssignmentSolver.h"
+#include "AuctionEngine.h"
+#include "BasisTree.h"
+#include "CostScalingEngine.h"
+#include "ShortestPathEngine.h"
+#include "SinkhornEngine.h"
+#include <stdexcept>
+#include <type_traits>
 
 namespace
 {
   using namespace TransportTask;
 
-  bool MarkAnyCycle(const Matrix<double> &i_solution, Matrix<int>& io_marks, 
-                    const PairOf<SizeType> &i_actual, const PairOf<SizeType> &i_dest, 
-                    bool walk_by_columns = false)
+  constexpr SizeType potentials_refresh_interval = 128;
+
+  // Solves without observer don't even read the clock
+  struct NullObserver
   {
-    if (walk_by_columns)
+    void OnInitialBasis(const Matrix<double>&, double) {}
+
+    void OnIteration(const IterationProgress&) {}
+
+    void OnFinished(const SolutionInfo&) {}
+  };
+
+  // Capacitated tasks always start from the creation method, the saturated cells are kept apart from the basis
+  Matrix<double> FormatInitialBasis(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options,
+                                    Vector<BasisCell>& o_saturated_cells)
+  {
+    if (i_data.IsCapacitated())
+      return FormatCapacitatedTask(i_data, i_method, o_saturated_cells);
+    if (i_options.detect_assignment && IsAssignmentShaped(i_data))
+      return SolveAssignment(i_data);
+    switch (i_options.engine)
     {
-      for (SizeType j = 0; j < i_solution.front().size(); ++j)
-      {
-        if (i_solution[i_actual.first][j] != empty_value && j != i_actual.second)
-        {
-          const auto checked_pos = std::make_pair(i_actual.first, j);
-          if (MarkAnyCycle(i_solution, io_marks, checked_pos, i_dest, false))
-          {
-            io_marks[i_actual.first][i_actual.second] = 1;
-            return true;
-          }
-        }
-      }
+    case SolverEngine::Potentials:
+      return FormatTask(i_data, i_method);
+    case SolverEngine::ShortestPaths:
+      return FormatTaskFromPlan(i_data, SolveByShortestPaths(i_data));
+    case SolverEngine::CostScaling:
+      return FormatTaskFromPlan(i_data, SolveByCostScaling(i_data));
+    case SolverEngine::Auction:
+      return FormatTaskFromApproximatePlan(i_data, SolveByAuction(i_data, i_options.thread_pool));
+    case SolverEngine::Sinkhorn:
+      return FormatTaskFromApproximatePlan(i_data, RoundPlan(i_data, SolveBySinkhorn(i_data, {}, i_options.thread_pool).plan));
     }
-    else
+    throw std::runtime_error{ "Undefined solver engine" };
+  }
+
+  template <typename Observer>
+  SolutionInfo Solve(const TransportInformation& i_data, const Matrix<double>& i_initial_basis, const Vector<BasisCell>& i_saturated_cells,
+                     const SolverOptions& i_options, Observer& io_observer)
+  {
+    constexpr bool is_observed = !std::is_same_v<Observer, NullObserver>;
+    const auto start_time = is_observed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    thread_local SolverWorkspace thread_workspace;
+    SolverWorkspace& workspace = i_options.workspace != nullptr ? *i_options.workspace : thread_workspace;
+    BasisTree basis(i_initial_basis, i_saturated_cells, i_data.m_costs_matrix, i_data.m_capacities, workspace);
+    double objective = basis.CalculateObjective();
+    io_observer.OnInitialBasis(i_initial_basis, objective);
+    auto pricing = CreatePricingPolicy(i_options.pricing, basis.GetRowsCount(), basis.GetColumnsCount(), i_options.thread_pool);
+    SolutionInfo solution_details;
+    solution_details.trace_level = i_options.trace_level;
+    SizeType iteration = 1;
+    for (;; ++iteration)
     {
-      if (i_actual.second == i_dest.second)
+      // Objective drift is dropped together with the drift of potentials
+      if (iteration % potentials_refresh_interval == 0)
       {
-        io_marks[i_actual.first][i_actual.second] = -1;
-        return true;
+        basis.RecalculatePotentials();
+        objective = basis.CalculateObjective();
       }
-
-      for (SizeType i = 0; i < i_solution.size(); ++i)
+      auto indexes = pricing->SelectEntering(i_data.m_costs_matrix, basis);
+      if (!indexes && basis.RecalculatePotentials() > potentials_tolerance)
+        indexes = pricing->SelectEntering(i_data.m_costs_matrix, basis);
+      if (i_options.trace_level != TraceLevel::Off)
+        solution_details.objectives.push_back(objective);
+      if (i_options.trace_level == TraceLevel::Full && (iteration - 1) % SolutionInfo::keyframe_interval == 0)
       {
-        if (i_solution[i][i_actual.second] != empty_value && i != i_actual.first)
-        {
-          const auto checked_pos = std::make_pair(i ,i_actual.second);
-          if (MarkAnyCycle(i_solution, io_marks, checked_pos, i_dest, true))
-          {
-            io_marks[i_actual.first][i_actual.second] = -1;
-            return true;
-          }
-        }
+        basis.CollectBasicCells(solution_details.keyframe_cells);
+        solution_details.keyframe_potentials.push_back(basis.GetPotentials());
+        if (solution_details.keyframe_saturated_offsets.empty())
+          solution_details.keyframe_saturated_offsets.push_back(0);
+        basis.CollectSaturatedCells(solution_details.keyframe_saturated_cells);
+        solution_details.keyframe_saturated_offsets.push_back(solution_details.keyframe_saturated_cells.size());
       }
-    }
-    return false;
-  }
-
-  void RecalculateMarkedCells(Matrix<double>& io_solution, const Matrix<int>& i_marks)
-  {
-    double min_diff_value = std::numeric_limits<double>::max();
-    PairOf<SizeType> best_indexes;
-    const SizeType height = io_solution.size();
-    const SizeType width = io_solution.front().size();
-
-    for (SizeType i = 0; i < height; ++i)
-    {
-      for (SizeType j = 0; j < width; ++j)
+      if (!indexes)
+        break;
+      const auto pivot = basis.Pivot(indexes.value());
+      if (i_options.trace_level != TraceLevel::Off)
+        solution_details.pivots.push_back(pivot);
+      if (i_options.trace_level == TraceLevel::Full)
       {
-        if (i_marks[i][j] == -1 && io_solution[i][j] < min_diff_value)
-        {
-          min_diff_value = io_solution[i][j];
-          best_indexes = std::make_pair(i, j);
-        }
+        if (solution_details.cycle_offsets.empty())
+          solution_details.cycle_offsets.push_back(0);
+        basis.CollectCycleCells(solution_details.cycle_cells);
+        solution_details.cycle_offsets.push_back(solution_details.cycle_cells.size());
       }
-    }
-
-    for (SizeType i = 0; i < height; ++i)
-    {
-      for (SizeType j = 0; j < width; ++j)
+      objective += pivot.theta * pivot.reduced_cost;
+      if constexpr (is_observed)
       {
-        io_solution[i][j] += i_marks[i][j] * min_diff_value;
+        io_observer.OnIteration({ iteration, objective, pivot.entering, basis.GetCycleLength(), std::chrono::steady_clock::now() - start_time });
       }
     }
-    io_solution[best_indexes.first][best_indexes.second] = empty_value;
+    solution_details.iterations_count = iteration;
+    solution_details.final_basis = basis.ToMatrix();
+    solution_details.final_potentials = basis.GetPotentials();
+    basis.CollectSaturatedCells(solution_details.saturated_cells);
+    solution_details.objective = objective;
+    io_observer.OnFinished(solution_details);
+    return solution_details;
   }
 
-  void RebuildSolutionMatrix(Matrix<double>& io_solution, const PairOf<SizeType>& i_pivot_indexes)
+  template <typename Observer>
+  SolutionInfo SolveFromScratch(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options, Observer& io_observer)
   {
-    Matrix<int> marks_matrix(io_solution.size(), Vector<int>(io_solution.front().size()));
-    auto [pivot_row, pivot_column] = i_pivot_indexes;
-    marks_matrix[pivot_row][pivot_column] = 1;
-    io_solution[pivot_row][pivot_column] = 0.0;
-    auto& processed_row = io_solution[pivot_row];
-    for (SizeType j = 0; j < processed_row.size(); ++j)
-    {
-      if (processed_row[j] != empty_value && j != i_pivot_indexes.second)
-      {
-        const auto start = std::make_pair(pivot_row, j);
-        if (MarkAnyCycle(io_solution, marks_matrix, start, i_pivot_indexes))
-        {
-          marks_matrix[start.first][start.second] = -1;
-          RecalculateMarkedCells(io_solution, marks_matrix);
-          return;
-        }
-      }
-    }
-    throw std::runtime_error{ "Matrix degenerated !" };
+    Vector<BasisCell> saturated_cells;
+    const auto initial_basis = FormatInitialBasis(i_data, i_method, i_options, saturated_cells);
+    return Solve(i_data, initial_basis, saturated_cells, i_options, io_observer);
+  }
+
+  template <typename Observer>
+  SolutionInfo SolveFromPlan(const TransportInformation& i_data, const Matrix<double>& i_plan, const SolverOptions& i_options, Observer& io_observer)
+  {
+    Vector<BasisCell> saturated_cells;
+    const auto initial_basis = FormatTaskFromApproximatePlan(i_data, i_plan, saturated_cells);
+    return Solve(i_data, initial_basis, saturated_cells, i_options, io_observer);
   }
 
-  OptionalPair<SizeType> GetInvalidElementIndexes(const Matrix<double>& i_costs, const Matrix<double> &i_solution_matrix, const MatrixPotentials& i_potentials)
+  // Capacitated tasks start from the previous plan with its saturated cells, the crossover fits it to the new quantities
+  // and capacities
+  template <typename Observer>
+  SolutionInfo SolveFromPrevious(const TransportInformation& i_data, const SolutionInfo& i_previous, CreationMethod i_fallback_method,
+                                 const SolverOptions& i_options, Observer& io_observer)
   {
-    OptionalPair<SizeType> pivot_indexes;
-    const SizeType rows_count = i_potentials.m_rows.size();
-    const SizeType columns_count = i_potentials.m_columns.size();
-    for (SizeType i = 0; i < rows_count; ++i)
+    const auto& previous_basis = i_previous.final_basis;
+    if (i_data.IsCapacitated())
     {
-      for (SizeType j = 0; j < columns_count; ++j)
-      {
-        if (i_solution_matrix[i][j] == empty_value)
-        {
-          const double potential = i_potentials.PotentialAt(i, j);
-          if (potential > i_costs[i][j])
-          {
-            if (!pivot_indexes)
-            {
-              pivot_indexes = std::make_pair(i, j);
-            }
-            else
-            {
-              auto& indexes = pivot_indexes.value();
-              const double best_diff = i_costs[indexes.first][indexes.second] - i_potentials.PotentialAt(indexes.first, indexes.second);
-              const double actual_diff = i_costs[i][j] - potential;
-              if (actual_diff > best_diff)
-                indexes = std::make_pair(i, j);
-            }
-          }
-        }
-      }
+      if (previous_basis.GetRowsCount() != i_data.m_resources.size() || previous_basis.GetColumnsCount() != i_data.m_requirements.size())
+        return SolveFromScratch(i_data, i_fallback_method, i_options, io_observer);
+      Matrix<double> previous_plan = previous_basis;
+      for (const auto& cell : i_previous.saturated_cells)
+        previous_plan[cell.row][cell.column] = cell.value;
+      return SolveFromPlan(i_data, previous_plan, i_options, io_observer);
     }
-    return pivot_indexes;
+    auto initial_basis = FormatTaskFromBasis(i_data, previous_basis);
+    if (!initial_basis)
+      return SolveFromScratch(i_data, i_fallback_method, i_options, io_observer);
+    return Solve(i_data, initial_basis.value(), {}, i_options, io_observer);
   }
 }
 
 namespace TransportTask
-{ 
-  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method)
+{
+  std::string GetEngineName(SolverEngine i_engine)
   {
-    auto feasible_solution = FormatTask(i_data, i_method);
-    SolutionInfo solution_details;
-    for(;;)
+    switch (i_engine)
     {
-      if (auto potentials_opt = CalculatePotentials(i_data, feasible_solution); potentials_opt)
-      {
-        auto potentials = std::move(potentials_opt.value());
-        solution_details.potentials.push_back(potentials);
-        solution_details.solution_steps.push_back(feasible_solution);
-        if (auto indexes = GetInvalidElementIndexes(i_data.m_costs_matrix, feasible_solution, potentials); indexes)
-        {
-          solution_details.rebuilding_pivots.push_back(indexes.value());
-          RebuildSolutionMatrix(feasible_solution, indexes.value());
-        }
-        else break;
-      }
-      else throw std::runtime_error{ "Matrix degenerated !" };
+    case SolverEngine::Potentials:
+      return "Potentials";
+    case SolverEngine::ShortestPaths:
+      return "Successive shortest paths";
+    case SolverEngine::CostScaling:
+      return "Cost scaling push-relabel";
+    case SolverEngine::Auction:
+      return "Auction";
+    case SolverEngine::Sinkhorn:
+      return "Sinkhorn with crossover";
     }
-    return solution_details;
+    throw std::runtime_error{ "Undefined solver engine" };
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options)
+  {
+    NullObserver observer;
+    return SolveFromScratch(i_data, i_method, i_options, observer);
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options,
+                                  SolveObserver& io_observer)
+  {
+    return SolveFromScratch(i_data, i_method, i_options, io_observer);
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const SolutionInfo& i_previous, CreationMethod i_fallback_method,
+                                  const SolverOptions& i_options)
+  {
+    NullObserver observer;
+    return SolveFromPrevious(i_data, i_previous, i_fallback_method, i_options, observer);
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const SolutionInfo& i_previous, CreationMethod i_fallback_method,
+                                  const SolverOptions& i_options, SolveObserver& io_observer)
+  {
+    return SolveFromPrevious(i_data, i_previous, i_fallback_method, i_options, io_observer);
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const Matrix<double>& i_plan, const SolverOptions& i_options)
+  {
+    NullObserver observer;
+    return SolveFromPlan(i_data, i_plan, i_options, observer);
+  }
+
+  SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const Matrix<double>& i_plan, const SolverOptions& i_options,
+                                  SolveObserver& io_observer)
+  {
+    return SolveFromPlan(i_data, i_plan, i_options, io_observer);
   }
 }
\ No newline at end of file
@@ -1,9 +1,51 @@
 #pragma once
 #include "Utility.h"
 #include "TableCreator.h"
+#include "PricingPolicy.h"
+#include "SolverWorkspace.h"
+#include "SolveObserver.h"
 #include "ExportHeader.h"
 
 namespace TransportTask
 {
-  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method);
+  // Engines other than Potentials find the optimal plan themselves, the simplex loop only turns it into the optimal basis.
+  // Sinkhorn finds an approximate plan, the loop finishes it from the crossover basis
+  enum class SolverEngine { Potentials, ShortestPaths, CostScaling, Auction, Sinkhorn, LAST };
+
+  SOLVER_API std::string GetEngineName(SolverEngine i_engine);
+
+  struct SolverOptions
+  {
+    SolverEngine engine = SolverEngine::Potentials;
+    // Assignment shaped tasks are solved by Jonker-Volgenant whatever engine is chosen
+    bool detect_assignment = true;
+    PricingSettings pricing;
+    // Pool used for pricing, auction bids and Sinkhorn scaling, it must not be the pool the solve itself is running on
+    ThreadPool* thread_pool = nullptr;
+    // Scratch buffers reused between solves, the workspace of the calling thread is used if it is not given
+    SolverWorkspace* workspace = nullptr;
+    TraceLevel trace_level = TraceLevel::Off;
+  };
+
+  // Creation method is used by the Potentials engine only. Capacitated tasks are always solved by Potentials from the
+  // basis of FormatCapacitatedTask
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options = {});
+
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, CreationMethod i_method, const SolverOptions& i_options,
+                                             SolveObserver& io_observer);
+
+  // Warm start from the final basis of a previous solve of the task with the same sizes : only the changed costs cost
+  // simplex iterations, changed quantities are repaired first. Capacitated tasks start from the previous plan with its
+  // saturated cells fitted to the new capacities. Tasks of other sizes are solved by the engine of the options
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const SolutionInfo& i_previous, CreationMethod i_fallback_method,
+                                             const SolverOptions& i_options = {});
+
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const SolutionInfo& i_previous, CreationMethod i_fallback_method,
+                                             const SolverOptions& i_options, SolveObserver& io_observer);
+
+  // Warm start from a plan close to optimal, the simplex loop starts from the basis of FormatTaskFromApproximatePlan
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const Matrix<double>& i_plan, const SolverOptions& i_options = {});
+
+  SOLVER_API SolutionInfo GetOptimalSolution(const TransportInformation& i_data, const Matrix<double>& i_plan, const SolverOptions& i_options,
+                                             SolveObserver& io_observer);
 }
\ No newline at end of file
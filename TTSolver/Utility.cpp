@@ -1,8 +1,134 @@
 #include "pch.h"
 #include "Utility.h"
+#include "ReducedCostKernel.h"
 #include <sstream>
 #include <algorithm>
+#include <cmath>
 #include <numeric>
+#include <stdexcept>
+
+namespace
+{
+  using namespace TransportTask;
+
+  // Replayed flows may differ from the solver ones by rounding, a cell leaving below it has left at zero
+  constexpr double flow_tolerance = 1e-9;
+
+  // Replays the pivots recorded after the nearest keyframe, potentials are restored only if o_potentials is given:
+  // removal of the leaving cell splits the tree and the part without the first row is shifted by the entering reduced cost.
+  // Saturated cells give the flow of a cell entering from its upper bound and take the cells leaving at their capacities,
+  // a cell moving to its other bound changes neither the tree nor the potentials
+  void RestoreStep(const SolutionInfo& i_solution, SizeType i_step_index, Matrix<double>& o_basis, Vector<BasisCell>& o_saturated_cells,
+                   MatrixPotentials* o_potentials)
+  {
+    const SizeType rows_count = i_solution.final_basis.GetRowsCount();
+    const SizeType columns_count = i_solution.final_basis.GetColumnsCount();
+    const SizeType nodes_count = rows_count + columns_count;
+    const SizeType keyframe_index = i_step_index / SolutionInfo::keyframe_interval;
+    o_basis = Matrix<double>(rows_count, columns_count, empty_value);
+    Vector<Vector<SizeType>> adjacency(o_potentials != nullptr ? nodes_count : 0);
+    for (SizeType k = keyframe_index * (nodes_count - 1); k < (keyframe_index + 1) * (nodes_count - 1); ++k)
+    {
+      const auto& cell = i_solution.keyframe_cells[k];
+      o_basis[cell.row][cell.column] = cell.value;
+      if (o_potentials != nullptr)
+      {
+        adjacency[cell.row].push_back(rows_count + cell.column);
+        adjacency[rows_count + cell.column].push_back(cell.row);
+      }
+    }
+    const auto& saturated_offsets = i_solution.keyframe_saturated_offsets;
+    o_saturated_cells.assign(i_solution.keyframe_saturated_cells.begin() + saturated_offsets[keyframe_index],
+                             i_solution.keyframe_saturated_cells.begin() + saturated_offsets[keyframe_index + 1]);
+    if (o_potentials != nullptr)
+      *o_potentials = i_solution.keyframe_potentials[keyframe_index];
+
+    auto find_saturated = [&o_saturated_cells](const PairOf<SizeType>& i_cell)
+    {
+      return std::find_if(o_saturated_cells.begin(), o_saturated_cells.end(), [&i_cell](const BasisCell& cell)
+      {
+        return cell.row == i_cell.first && cell.column == i_cell.second;
+      });
+    };
+    Vector<std::uint8_t> is_root_side;
+    Vector<SizeType> nodes_stack;
+    for (SizeType pivot_index = keyframe_index * SolutionInfo::keyframe_interval; pivot_index < i_step_index; ++pivot_index)
+    {
+      const auto& pivot = i_solution.pivots[pivot_index];
+      auto [leaving_row, leaving_column] = pivot.leaving;
+      auto [entering_row, entering_column] = pivot.entering;
+      // Saturated entering cell decreases its flow from the capacity, other ones increase it from zero
+      double entering_flow = pivot.theta;
+      const auto entering_saturated = find_saturated(pivot.entering);
+      if (entering_saturated != o_saturated_cells.end())
+      {
+        entering_flow += entering_saturated->value;
+        *entering_saturated = o_saturated_cells.back();
+        o_saturated_cells.pop_back();
+      }
+      for (SizeType k = i_solution.cycle_offsets[pivot_index] + 1; k < i_solution.cycle_offsets[pivot_index + 1]; ++k)
+      {
+        const auto& cell = i_solution.cycle_cells[k];
+        if ((k - i_solution.cycle_offsets[pivot_index]) % 2 == 0)
+          o_basis[cell.row][cell.column] += pivot.theta;
+        else
+          o_basis[cell.row][cell.column] -= pivot.theta;
+      }
+      if (pivot.leaving == pivot.entering)
+      {
+        if (pivot.theta > 0.0)
+          o_saturated_cells.push_back({ static_cast<std::uint32_t>(entering_row), static_cast<std::uint32_t>(entering_column), entering_flow });
+        continue;
+      }
+      // Cell leaving at its lower bound is left with no flow, the one leaving at its capacity keeps it
+      const double leaving_flow = o_basis[leaving_row][leaving_column];
+      if (std::abs(leaving_flow) > flow_tolerance)
+        o_saturated_cells.push_back({ static_cast<std::uint32_t>(leaving_row), static_cast<std::uint32_t>(leaving_column), leaving_flow });
+      o_basis[leaving_row][leaving_column] = empty_value;
+      o_basis[entering_row][entering_column] = entering_flow;
+      if (o_potentials == nullptr)
+        continue;
+
+      auto detach = [&adjacency](SizeType i_node, SizeType i_neighbour)
+      {
+        auto& neighbours = adjacency[i_node];
+        *std::find(neighbours.begin(), neighbours.end(), i_neighbour) = neighbours.back();
+        neighbours.pop_back();
+      };
+      detach(leaving_row, rows_count + leaving_column);
+      detach(rows_count + leaving_column, leaving_row);
+      is_root_side.assign(nodes_count, 0);
+      is_root_side.front() = 1;
+      nodes_stack.assign(1, 0);
+      while (!nodes_stack.empty())
+      {
+        const SizeType node = nodes_stack.back();
+        nodes_stack.pop_back();
+        for (SizeType neighbour : adjacency[node])
+        {
+          if (!is_root_side[neighbour])
+          {
+            is_root_side[neighbour] = 1;
+            nodes_stack.push_back(neighbour);
+          }
+        }
+      }
+      const double rows_shift = is_root_side[entering_row] ? -pivot.reduced_cost : pivot.reduced_cost;
+      for (SizeType i = 0; i < rows_count; ++i)
+      {
+        if (!is_root_side[i])
+          o_potentials->m_rows[i] += rows_shift;
+      }
+      for (SizeType j = 0; j < columns_count; ++j)
+      {
+        if (!is_root_side[rows_count + j])
+          o_potentials->m_columns[j] -= rows_shift;
+      }
+      adjacency[entering_row].push_back(rows_count + entering_column);
+      adjacency[rows_count + entering_column].push_back(entering_row);
+    }
+  }
+}
 
 namespace TransportTask
 {
@@ -17,15 +143,41 @@ namespace TransportTask
     {
       m_state = ResourcesState::Overflow;
       m_requirements.push_back(resources_sum - requirements_sum);
-      for (auto& row : m_costs_matrix)
-        row.push_back(0);
     }
     else if (requirements_sum > resources_sum)
     {
       m_state = ResourcesState::Sufficient;
       m_resources.push_back(requirements_sum - resources_sum);
-      m_costs_matrix.emplace_back(m_costs_matrix.front().size(), 0.0);
     }
+    if (m_state != ResourcesState::Normal)
+    {
+      // Fictive row or column has zero costs
+      Matrix<double> balanced_costs(m_resources.size(), m_requirements.size(), 0.0);
+      for (SizeType i = 0; i < i_cost.GetRowsCount(); ++i)
+        std::copy(i_cost[i].begin(), i_cost[i].end(), balanced_costs[i].begin());
+      m_costs_matrix = std::move(balanced_costs);
+    }
+  }
+
+  TransportInformation::TransportInformation(const Matrix<double>& i_cost, const Vector<double> i_resources, const Vector<double> i_requirements,
+                                             const Matrix<double>& i_capacities)
+    :TransportInformation(i_cost, i_resources, i_requirements)
+  {
+    if (i_capacities.GetRowsCount() != i_cost.GetRowsCount() || i_capacities.GetColumnsCount() != i_cost.GetColumnsCount())
+      throw std::runtime_error{ "Capacities don't match the costs !" };
+    m_capacities = Matrix<double>(m_resources.size(), m_requirements.size(), std::numeric_limits<double>::infinity());
+    for (SizeType i = 0; i < i_capacities.GetRowsCount(); ++i)
+      std::copy(i_capacities[i].begin(), i_capacities[i].end(), m_capacities[i].begin());
+  }
+
+  bool TransportInformation::IsCapacitated() const
+  {
+    return m_capacities.GetRowsCount() != 0;
+  }
+
+  double TransportInformation::CapacityAt(SizeType i_row, SizeType i_column) const
+  {
+    return IsCapacitated() ? m_capacities[i_row][i_column] : std::numeric_limits<double>::infinity();
   }
 
   std::optional<std::string> TransportInformation::GetMessageForState() const
@@ -47,9 +199,9 @@ namespace TransportTask
   Vector<std::string> GetResoucesDistributionDetails(const Matrix<double>& i_feasible_solution)
   {
     Vector<std::string> distribution_log;
-    for (SizeType i = 0; i < i_feasible_solution.size(); ++i)
+    for (SizeType i = 0; i < i_feasible_solution.GetRowsCount(); ++i)
     {
-      for (SizeType j = 0; j < i_feasible_solution[i].size(); ++j)
+      for (SizeType j = 0; j < i_feasible_solution.GetColumnsCount(); ++j)
       {
         const double resource_amount = i_feasible_solution[i][j];
         if (resource_amount != empty_value && resource_amount != 0.0)
@@ -85,21 +237,26 @@ namespace TransportTask
 
   double CalculateTransportPrice(const Matrix<double>& i_actual_solution, const Matrix<double>& i_costs)
   {
-    const SizeType rows_count = i_actual_solution.size();
-    const SizeType columns_count = i_actual_solution.front().size();
+    const SizeType rows_count = i_actual_solution.GetRowsCount();
+    const SizeType columns_count = i_actual_solution.GetColumnsCount();
     double accumulation = 0;
     for (SizeType row = 0; row < rows_count; ++row)
+      accumulation += RowTransportPrice(i_actual_solution[row].data(), i_costs[row].data(), columns_count);
+    return accumulation;
+  }
+
+  std::string GetTraceLevelName(TraceLevel i_level)
+  {
+    switch (i_level)
     {
-      for (SizeType column = 0; column < columns_count; ++column)
-      {
-        const double current_element = i_actual_solution[row][column];
-        if (current_element != empty_value)
-        {
-          accumulation += current_element * i_costs[row][column];
-        }
-      }
+    case TraceLevel::Off:
+      return "Off";
+    case TraceLevel::PivotsOnly:
+      return "Pivots only";
+    case TraceLevel::Full:
+      return "Full";
     }
-    return accumulation;
+    throw std::runtime_error{ "Undefined trace level" };
   }
 
   std::string GetStepDescription(const SolutionInfo& prepared_solution, SizeType step_index)
@@ -109,11 +266,32 @@ namespace TransportTask
     {
       string_stream << "Formed initial feasible solution";
     }
+    else if (step_index <= prepared_solution.pivots.size())
+    {
+      const auto& pivot = prepared_solution.pivots[step_index - 1];
+      auto [pivot_row, pivot_column] = pivot.entering;
+      auto [leaving_row, leaving_column] = pivot.leaving;
+      if (pivot.leaving == pivot.entering)
+      {
+        // Entering cell reached its other bound first, the basis is the same
+        string_stream << "Got " << step_index + 1 << " feasible solution after moving element at index [" << pivot_row + 1 << ", "
+          << pivot_column + 1 << "] to its " << (pivot.theta > 0.0 ? "capacity" : "zero flow") << ", the basis didn't change, "
+          << std::abs(pivot.theta) << " units were moved along the cycle";
+      }
+      else
+      {
+        string_stream << "Got " << step_index + 1 << " feasible solution after rebuilding previous matrix with pivot element at index ["
+          << pivot_row + 1 << ", " << pivot_column + 1 << "], element at index [" << leaving_row + 1 << ", " << leaving_column + 1
+          << "] left the basis, " << std::abs(pivot.theta) << " units were moved along the cycle";
+      }
+    }
+    else if (step_index + 1 == prepared_solution.GetIterationsCount())
+    {
+      string_stream << "Got optimal solution after " << step_index << " rebuildings";
+    }
     else
     {
-      auto [pivot_row, pivot_column] = prepared_solution.rebuilding_pivots[step_index - 1];
-      string_stream << "Got " << step_index + 1 << " feasible solution after rebuilding previous matrix with pivot element at index ["
-        << pivot_row + 1 << ", " << pivot_column + 1 << "]";
+      throw std::runtime_error{ "Step isn't recorded at trace level " + GetTraceLevelName(prepared_solution.trace_level) };
     }
 
     /*if (step_index == prepared_solution.solution_steps.size() - 1)
@@ -125,24 +303,86 @@ namespace TransportTask
   
   SizeType SolutionInfo::GetIterationsCount() const
   {
-    return solution_steps.size();
+    return iterations_count;
   }
-  
-  double SolutionInfo::GetMatrixCostAtStep(SizeType step_index, const Matrix<double>& costs_matrix) const
+
+  bool SolutionInfo::IsStepRecorded(SizeType step_index) const
+  {
+    return step_index + 1 == iterations_count || (trace_level == TraceLevel::Full && step_index < iterations_count);
+  }
+
+  Matrix<double> SolutionInfo::GetMatrixAtStep(SizeType step_index) const
+  {
+    if (step_index + 1 == iterations_count)
+      return final_basis;
+    if (!IsStepRecorded(step_index))
+      throw std::runtime_error{ "Step isn't recorded at trace level " + GetTraceLevelName(trace_level) };
+    Matrix<double> basis;
+    Vector<BasisCell> saturated;
+    RestoreStep(*this, step_index, basis, saturated, nullptr);
+    return basis;
+  }
+
+  MatrixPotentials SolutionInfo::GetPotentialsAtStep(SizeType step_index) const
+  {
+    if (step_index + 1 == iterations_count)
+      return final_potentials;
+    if (!IsStepRecorded(step_index))
+      throw std::runtime_error{ "Step isn't recorded at trace level " + GetTraceLevelName(trace_level) };
+    Matrix<double> basis;
+    Vector<BasisCell> saturated;
+    MatrixPotentials potentials(0, 0);
+    RestoreStep(*this, step_index, basis, saturated, &potentials);
+    return potentials;
+  }
+
+  Vector<BasisCell> SolutionInfo::GetSaturatedCellsAtStep(SizeType step_index) const
+  {
+    if (step_index + 1 == iterations_count)
+      return saturated_cells;
+    if (!IsStepRecorded(step_index))
+      throw std::runtime_error{ "Step isn't recorded at trace level " + GetTraceLevelName(trace_level) };
+    Matrix<double> basis;
+    Vector<BasisCell> saturated;
+    RestoreStep(*this, step_index, basis, saturated, nullptr);
+    return saturated;
+  }
+
+  double SolutionInfo::GetObjectiveAtStep(SizeType step_index) const
+  {
+    if (step_index + 1 == iterations_count)
+      return objective;
+    if (step_index >= objectives.size())
+      throw std::runtime_error{ "Step isn't recorded at trace level " + GetTraceLevelName(trace_level) };
+    return objectives[step_index];
+  }
+
+  // Costs matrix is left unnamed, it stays in the signature for API compatibility only
+  double SolutionInfo::GetMatrixCostAtStep(SizeType step_index, const Matrix<double>&) const
+  {
+    return GetObjectiveAtStep(step_index);
+  }
+
+  double SolutionInfo::GetObjectiveDrift(const Matrix<double>& costs_matrix) const
   {
-    return CalculateTransportPrice(solution_steps[step_index], costs_matrix);
+    double recalculated_objective = CalculateTransportPrice(final_basis, costs_matrix);
+    for (const auto& cell : saturated_cells)
+      recalculated_objective += cell.value * costs_matrix[cell.row][cell.column];
+    return std::abs(objective - recalculated_objective);
   }
 
   SizeType SolutionInfo::GetAmountOfBytesSpent() const
   {
-    const SizeType iterations_count = GetIterationsCount();
-    const SizeType rows_count = potentials.front().m_rows.size();
-    const SizeType columns_count = potentials.front().m_columns.size();
+    const SizeType rows_count = final_basis.GetRowsCount();
+    const SizeType columns_count = final_basis.GetColumnsCount();
 
-    const SizeType spent_for_matrices = iterations_count * rows_count * columns_count * sizeof(double);
-    const SizeType spent_for_potentials = potentials.size() * (rows_count + columns_count) * sizeof(double);
-    const SizeType spent_for_pivots = 2 * rebuilding_pivots.size() * sizeof(SizeType);
+    const SizeType spent_for_final_basis = rows_count * final_basis.GetRowStride() * sizeof(double);
+    const SizeType spent_for_potentials = (keyframe_potentials.size() + 1) * (rows_count + columns_count) * sizeof(double);
+    const SizeType spent_for_pivots = pivots.size() * sizeof(PivotRecord) + objectives.size() * sizeof(double);
+    const SizeType spent_for_keyframes = (keyframe_cells.size() + keyframe_saturated_cells.size() + saturated_cells.size()) * sizeof(BasisCell)
+                                       + keyframe_saturated_offsets.size() * sizeof(SizeType);
+    const SizeType spent_for_cycles = cycle_cells.size() * sizeof(CycleCell) + cycle_offsets.size() * sizeof(SizeType);
 
-    return spent_for_matrices + spent_for_pivots + spent_for_potentials;
+    return spent_for_final_basis + spent_for_potentials + spent_for_pivots + spent_for_keyframes + spent_for_cycles;
   }
 }
\ No newline at end of file
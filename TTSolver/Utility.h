@@ -1,6 +1,9 @@
 #pragma once
 #include "ExportHeader.h"
+#include "Matrix.h"
+#include <cstdint>
 #include <vector>
+#include <limits>
 #include <optional>
 #include <string>
 
@@ -10,7 +13,7 @@ namespace TransportTask
   using Vector = std::vector<T>;
 
   template <typename T>
-  using Matrix = Vector<Vector<T>>;
+  using NestedMatrix = Vector<Vector<T>>;
 
   using SizeType = std::size_t;
 
@@ -22,17 +25,30 @@ namespace TransportTask
 
   constexpr double empty_value = std::numeric_limits<double>::lowest();
 
+  constexpr double potentials_tolerance = 1e-9;
+
   class TransportInformation
   {
     enum class ResourcesState { Normal, Sufficient, Overflow };
   public:
     SOLVER_API TransportInformation(const Matrix<double>& i_cost, const Vector<double> i_resources, const Vector<double> i_requirements);
 
+    // Flow of cell (i, j) can't exceed i_capacities[i][j], cells of the fictive line aren't bounded
+    SOLVER_API TransportInformation(const Matrix<double>& i_cost, const Vector<double> i_resources, const Vector<double> i_requirements,
+                                    const Matrix<double>& i_capacities);
+
     SOLVER_API std::optional<std::string> GetMessageForState() const;
 
+    SOLVER_API bool IsCapacitated() const;
+
+    // Infinity for the tasks without capacities
+    SOLVER_API double CapacityAt(SizeType i_row, SizeType i_column) const;
+
     Matrix<double> m_costs_matrix;
     Vector<double> m_requirements;
     Vector<double> m_resources;
+    // Empty if the cells aren't bounded
+    Matrix<double> m_capacities;
   private:
     ResourcesState m_state = ResourcesState::Normal;
   };
@@ -55,16 +71,80 @@ namespace TransportTask
 
   SOLVER_API double CalculateTransportPrice(const Matrix<double>& i_actual_solution, const Matrix<double>& i_costs);
 
+  // Off keeps only the final basis and objective, PivotsOnly adds the pivots and objectives of the steps, Full adds every intermediate basis and potentials
+  enum class TraceLevel { Off, PivotsOnly, Full, LAST };
+
+  SOLVER_API std::string GetTraceLevelName(TraceLevel i_level);
+
+  struct PivotRecord
+  {
+    PairOf<SizeType> entering;
+    PairOf<SizeType> leaving;
+    double theta;
+    double reduced_cost;
+  };
+
+  struct BasisCell
+  {
+    std::uint32_t row;
+    std::uint32_t column;
+    double value;
+  };
+
+  struct CycleCell
+  {
+    std::uint32_t row;
+    std::uint32_t column;
+  };
+
   struct SolutionInfo
   {
-    Vector<Matrix<double>> solution_steps;
-    Vector<MatrixPotentials> potentials;
-    Vector<PairOf<SizeType>> rebuilding_pivots;
+    static constexpr SizeType keyframe_interval = 32;
+
+    TraceLevel trace_level = TraceLevel::Off;
+    Matrix<double> final_basis;
+    MatrixPotentials final_potentials{ 0, 0 };
+    double objective = 0.0;
+    // Bound of objective minus the optimal objective, zero for exact engines
+    double optimality_gap = 0.0;
+    // Capacitated tasks : non-basic cells carrying their capacities, the final basis keeps only the basic cells
+    Vector<BasisCell> saturated_cells;
+    // Amount of bases met by the solve, the initial and the final ones included
+    SizeType iterations_count = 0;
+    Vector<PivotRecord> pivots;
+    Vector<double> objectives;
+    // Full trace level keeps basic cells and potentials of every keyframe_interval step and the cells of every pivot cycle,
+    // cycle of pivot k lies in [cycle_offsets[k], cycle_offsets[k + 1]), it starts from the entering cell and
+    // its flow is increased on even positions and decreased on odd ones. Saturated cells of keyframe k lie in
+    // [keyframe_saturated_offsets[k], keyframe_saturated_offsets[k + 1])
+    Vector<BasisCell> keyframe_cells;
+    Vector<MatrixPotentials> keyframe_potentials;
+    Vector<BasisCell> keyframe_saturated_cells;
+    Vector<SizeType> keyframe_saturated_offsets;
+    Vector<CycleCell> cycle_cells;
+    Vector<SizeType> cycle_offsets;
 
     SOLVER_API SizeType GetIterationsCount() const;
 
+    SOLVER_API bool IsStepRecorded(SizeType step_index) const;
+
+    // Steps between keyframes are restored by replaying at most keyframe_interval pivots
+    SOLVER_API Matrix<double> GetMatrixAtStep(SizeType step_index) const;
+
+    SOLVER_API MatrixPotentials GetPotentialsAtStep(SizeType step_index) const;
+
+    // Non-basic cells carrying their capacities at the step, empty for the tasks without capacities
+    SOLVER_API Vector<BasisCell> GetSaturatedCellsAtStep(SizeType step_index) const;
+
+    // Objective is tracked by the solver, so the recorded steps are answered without touching the matrices
+    SOLVER_API double GetObjectiveAtStep(SizeType step_index) const;
+
+    // Costs matrix isn't used any more, the overload is kept for the existing callers
     SOLVER_API double GetMatrixCostAtStep(SizeType step_index, const Matrix<double>& costs_matrix) const;
 
+    // Difference between the tracked objective and the one recalculated over the final basis
+    SOLVER_API double GetObjectiveDrift(const Matrix<double>& costs_matrix) const;
+
     SOLVER_API SizeType GetAmountOfBytesSpent() const;
   };
 
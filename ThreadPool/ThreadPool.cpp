@@ -1,4 +1,5 @@
 #include "ThreadPool.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -41,6 +42,51 @@ void ThreadPool::Wait(int msec_wait_interval)
   }
 }
 
+unsigned ThreadPool::GetThreadsCount() const
+{
+  return static_cast<unsigned>(m_threads.size());
+}
+
+std::size_t GetRangesCount(const ThreadPool* thread_pool, std::size_t items_count, std::size_t item_size)
+{
+  if (thread_pool == nullptr || items_count * item_size < ThreadPool::parallel_work_threshold)
+    return 1;
+  return std::min<std::size_t>(items_count, thread_pool->GetThreadsCount() * ThreadPool::ranges_per_thread);
+}
+
+void ThreadPool::RunRanges(RangeInvoker invoker, const void* function, std::size_t items_count, std::size_t ranges_count)
+{
+  std::lock_guard<std::mutex> ranges_lock{ m_ranges_mutex };
+  std::unique_lock<std::mutex> lock{ m_queue_mutex };
+  m_ranges_invoker = invoker;
+  m_ranges_function = function;
+  m_items_count = items_count;
+  m_ranges_count = ranges_count;
+  m_next_range = 0;
+  m_finished_ranges = 0;
+  lock.unlock();
+  m_notifier.notify_all();
+
+  lock.lock();
+  while (RunNextRange(lock));
+  m_ranges_finished.wait(lock, [this] { return m_finished_ranges == m_ranges_count; });
+  m_ranges_count = 0;
+  m_next_range = 0;
+}
+
+bool ThreadPool::RunNextRange(std::unique_lock<std::mutex>& lock)
+{
+  if (m_next_range == m_ranges_count)
+    return false;
+  const std::size_t range = m_next_range++;
+  lock.unlock();
+  m_ranges_invoker(m_ranges_function, range, m_items_count * range / m_ranges_count, m_items_count * (range + 1) / m_ranges_count);
+  lock.lock();
+  if (++m_finished_ranges == m_ranges_count)
+    m_ranges_finished.notify_all();
+  return true;
+}
+
 void ThreadPool::RunExecution()
 {
   bool initialized = false;
@@ -53,9 +99,11 @@ void ThreadPool::RunExecution()
     }
     initialized = true;
 
-    m_notifier.wait(lock, [this] {return m_stop_flag || !m_available_tasks.empty(); });
+    m_notifier.wait(lock, [this] {return m_stop_flag || !m_available_tasks.empty() || m_next_range != m_ranges_count; });
     if (!m_stop_flag)
     {
+      if (RunNextRange(lock))
+        continue;
       ++m_active_threads_count;
       auto current_task = std::move(m_available_tasks.front());
       m_available_tasks.pop();
@@ -18,7 +18,18 @@ public:
     Execute(Function function, Args&& ... arguments);
 
   void Wait(int msec_wait_interval = 10);
+
+  unsigned GetThreadsCount() const;
+
+  // Work below the threshold isn't worth waking the threads, bigger work is split into some ranges per thread
+  static constexpr std::size_t parallel_work_threshold = 1 << 16;
+  static constexpr std::size_t ranges_per_thread = 4;
 private:
+  using RangeInvoker = void (*)(const void*, std::size_t, std::size_t, std::size_t);
+
+  template <typename RangeFunction>
+  friend void RunInRanges(ThreadPool* thread_pool, std::size_t items_count, std::size_t item_size, const RangeFunction& function);
+
   std::vector<std::thread> m_threads;
   std::queue<std::function<void()>> m_available_tasks;
   std::mutex m_queue_mutex, m_log_mutex;
@@ -27,9 +38,43 @@ private:
   bool m_stop_flag{ false };
   std::atomic<unsigned> m_active_threads_count{ 0 };
 
+  // Ranges of the running RunInRanges call, they are taken by the threads and by the calling thread one by one
+  std::mutex m_ranges_mutex;
+  std::condition_variable m_ranges_finished;
+  RangeInvoker m_ranges_invoker{ nullptr };
+  const void* m_ranges_function{ nullptr };
+  std::size_t m_items_count{ 0 }, m_ranges_count{ 0 }, m_next_range{ 0 }, m_finished_ranges{ 0 };
+
   void RunExecution();
+
+  void RunRanges(RangeInvoker invoker, const void* function, std::size_t items_count, std::size_t ranges_count);
+
+  // Takes the next range of the running call under the locked queue mutex, false if all of them are taken
+  bool RunNextRange(std::unique_lock<std::mutex>& lock);
 };
 
+// Amount of ranges RunInRanges splits the items into, 1 if the work is run by the calling thread
+std::size_t GetRangesCount(const ThreadPool* thread_pool, std::size_t items_count, std::size_t item_size);
+
+// Runs function(range, first, last) over the ranges of [0, items_count), the calling thread takes ranges too and returns
+// when all of them are done. Nothing is allocated, so it may be called on every pivot. Ranges depend only on the amount
+// of threads, the function must not throw
+template <typename RangeFunction>
+void RunInRanges(ThreadPool* thread_pool, std::size_t items_count, std::size_t item_size, const RangeFunction& function)
+{
+  const std::size_t ranges_count = GetRangesCount(thread_pool, items_count, item_size);
+  if (ranges_count == 1)
+  {
+    function(std::size_t{ 0 }, std::size_t{ 0 }, items_count);
+    return;
+  }
+  auto invoker = [](const void* range_function, std::size_t range, std::size_t first, std::size_t last)
+  {
+    (*static_cast<const RangeFunction*>(range_function))(range, first, last);
+  };
+  thread_pool->RunRanges(invoker, &function, items_count, ranges_count);
+}
+
 template<typename Function, typename ...Args>
 std::future<typename std::result_of<Function(Args...)>::type>
 ThreadPool::Execute(Function function, Args&& ...arguments)